@@ -0,0 +1,433 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L  // clock_gettime(), popen()
+#endif
+
+#include "TDA8425_emu.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "clock.h"
+#include "sample_format.h"
+
+#ifdef __WINDOWS__
+#define popen   _popen
+#define pclose  _pclose
+#endif
+
+
+static char const* USAGE = ("\
+TDA8425_bench (c) 2020-2024, Andrea Zoppi. All rights reserved.\n\
+\n\
+This program measures the speed of the TDA8425 emulator, and prints the\n\
+results as a JSON object to standard output, so that they can be compared\n\
+across versions.\n\
+The floating point type is the one the program is built with, see\n\
+TDA8425_FLOAT; make_gcc.sh builds both TDA8425_bench (double) and\n\
+TDA8425_bench_float (float).\n\
+\n\
+\n\
+USAGE:\n\
+  bench [OPTION]...\n\
+\n\
+\n\
+OPTION:\n\
+\n\
+-h, --help\n\
+    Prints this help message and quits.\n\
+\n\
+--min-time SECONDS\n\
+    Minimum time of each measurement trial [s]; default: 0.1.\n\
+    Each process and write result is the best of 3 trials; the pipe is\n\
+    run on longer signals until it takes as long.\n\
+\n\
+--pipe PATH\n\
+    TDA8425_pipe executable for the end-to-end throughput, run on a\n\
+    generated signal with discarded output; default: ./TDA8425_pipe.\n\
+    The result is null if it cannot be run.\n\
+\n\
+-r, --rate RATE\n\
+    Sample rate [Hz]; default: 48000.\n\
+\n\
+\n\
+RESULTS:\n\
+\n\
+- process: ns/frame of TDA8425_Chip_Process() and\n\
+  TDA8425_Chip_ProcessBlock(), per stereo mode, T-filter, and DC removal.\n\
+- write: ns/write of TDA8425_Chip_Write() per register, alternating two\n\
+  values, alone and followed by the first block processed after it.\n\
+- formats: GB/s of stream data of each FORMAT decoder and encoder.\n\
+- pipe: frames/s and real-time factor of TDA8425_pipe, stereo S16_LE.\n\
+");
+
+
+#define BENCH_FRAMES  4096  // cache resident
+#define BENCH_TRIALS  3
+
+typedef void (*BenchTask)(void* context, long rounds);
+
+static double g_min_time = 0.1;
+static double g_rate = 48000;
+
+
+// Runs a task for at least the minimum time per trial; returns the best time
+// per round [s]
+static double Bench_Measure(BenchTask task, void* context)
+{
+    double best = HUGE_VAL;
+
+    task(context, 1);  // warm-up
+    for (int trial = 0; trial < BENCH_TRIALS; ++trial) {
+        long rounds = 0;
+        long batch = 1;
+        double start = Clock_Seconds();
+        double elapsed;
+        do {
+            task(context, batch);
+            rounds += batch;
+            elapsed = Clock_Seconds() - start;
+            if (elapsed < g_min_time / 16) {
+                batch *= 2;
+            }
+        } while (elapsed < g_min_time);
+
+        if (best > elapsed / (double)rounds) {
+            best = elapsed / (double)rounds;
+        }
+    }
+    return best;
+}
+
+
+// Deterministic noise, within [-1, +1)
+static double Bench_Noise(uint32_t* seed)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+    return (double)(*seed >> 8) * (2.0 / 16777216.0) - 1;
+}
+
+
+// ============================================================================
+
+typedef struct ProcessBench {
+    TDA8425_Chip chip;
+    TDA8425_Chip_Process_Data frames[BENCH_FRAMES];
+    TDA8425_Address address;
+    TDA8425_Register values[2];
+} ProcessBench;
+
+
+static void ProcessBench_Setup(ProcessBench* self, TDA8425_Mode mode, int tfilter, int dcremoval)
+{
+    uint32_t seed = 1;
+
+    // T-filter and DC removal are enabled by clearing their SF bits
+    TDA8425_Register sf = (TDA8425_Register)(
+        (TDA8425_Register)TDA8425_Selector_Stereo_1 |
+        ((TDA8425_Register)mode << TDA8425_Reg_SF_STL) |
+        (tfilter ? 0u : (1u << TDA8425_Reg_SF_TF)) |
+        (dcremoval ? 0u : (1u << TDA8425_Reg_SF_DC))
+    );
+
+    TDA8425_Chip_Ctor(&self->chip);
+    TDA8425_Chip_Setup(&self->chip, (TDA8425_Float)g_rate,
+                       TDA8425_Pseudo_C1_Table[0], TDA8425_Pseudo_C2_Table[0],
+                       (tfilter ? TDA8425_Tfilter_Mode_Enabled : TDA8425_Tfilter_Mode_Disabled));
+    TDA8425_Chip_Reset(&self->chip);
+    TDA8425_Chip_Write(&self->chip, (TDA8425_Address)TDA8425_Reg_VL, (TDA8425_Register)TDA8425_Volume_Data_Unity);
+    TDA8425_Chip_Write(&self->chip, (TDA8425_Address)TDA8425_Reg_VR, (TDA8425_Register)TDA8425_Volume_Data_Unity);
+    TDA8425_Chip_Write(&self->chip, (TDA8425_Address)TDA8425_Reg_BA, (TDA8425_Register)(TDA8425_Tone_Data_Unity + 3));
+    TDA8425_Chip_Write(&self->chip, (TDA8425_Address)TDA8425_Reg_TR, (TDA8425_Register)(TDA8425_Tone_Data_Unity - 2));
+    TDA8425_Chip_Write(&self->chip, (TDA8425_Address)TDA8425_Reg_SF, sf);
+    TDA8425_Chip_Start(&self->chip);
+
+    for (int i = 0; i < BENCH_FRAMES; ++i) {
+        for (int s = 0; s < TDA8425_Source_Count; ++s) {
+            for (int c = 0; c < TDA8425_Stereo_Count; ++c) {
+                self->frames[i].inputs[s][c] = (TDA8425_Float)(0.25 * Bench_Noise(&seed));
+            }
+        }
+    }
+}
+
+
+static void ProcessBench_Cleanup(ProcessBench* self)
+{
+    TDA8425_Chip_Stop(&self->chip);
+    TDA8425_Chip_Dtor(&self->chip);
+}
+
+
+static void ProcessTask(void* context, long rounds)
+{
+    ProcessBench* self = (ProcessBench*)context;
+
+    for (long r = 0; r < rounds; ++r) {
+        for (int i = 0; i < BENCH_FRAMES; ++i) {
+            TDA8425_Chip_Process(&self->chip, &self->frames[i]);
+        }
+    }
+}
+
+
+static void ProcessBlockTask(void* context, long rounds)
+{
+    ProcessBench* self = (ProcessBench*)context;
+
+    for (long r = 0; r < rounds; ++r) {
+        TDA8425_Chip_ProcessBlock(&self->chip, self->frames, BENCH_FRAMES);
+    }
+}
+
+
+static void WriteTask(void* context, long rounds)
+{
+    ProcessBench* self = (ProcessBench*)context;
+
+    for (long r = 0; r < rounds; ++r) {
+        TDA8425_Chip_Write(&self->chip, self->address, self->values[r & 1]);
+    }
+}
+
+
+// Writes, and processes the first block after each, refreshing its kernels
+static void WriteRefreshTask(void* context, long rounds)
+{
+    ProcessBench* self = (ProcessBench*)context;
+
+    for (long r = 0; r < rounds; ++r) {
+        TDA8425_Chip_Write(&self->chip, self->address, self->values[r & 1]);
+        TDA8425_Chip_ProcessBlock(&self->chip, self->frames, TDA8425_BLOCK_SIZE);
+    }
+}
+
+
+static void RunProcessBench(ProcessBench* bench)
+{
+    static char const* const MODE_LABELS[TDA8425_Mode_Count] = { "mono", "linear", "pseudo", "spatial" };
+    int first = 1;
+
+    printf("  \"process\": [");
+    for (int mode = 0; mode < TDA8425_Mode_Count; ++mode) {
+        for (int tfilter = 0; tfilter < 2; ++tfilter) {
+            for (int dcremoval = 0; dcremoval < 2; ++dcremoval) {
+                ProcessBench_Setup(bench, (TDA8425_Mode)mode, tfilter, dcremoval);
+                double process = Bench_Measure(ProcessTask, bench);
+                double block = Bench_Measure(ProcessBlockTask, bench);
+                ProcessBench_Cleanup(bench);
+
+                printf("%s\n    { \"mode\": \"%s\", \"tfilter\": %s, \"dcremoval\": %s, "
+                       "\"process_ns\": %.3f, \"block_ns\": %.3f }",
+                       (first ? "" : ","), MODE_LABELS[mode],
+                       (tfilter ? "true" : "false"), (dcremoval ? "true" : "false"),
+                       process * 1e9 / BENCH_FRAMES, block * 1e9 / BENCH_FRAMES);
+                first = 0;
+            }
+        }
+    }
+    printf("\n  ],\n");
+}
+
+
+static void RunWriteBench(ProcessBench* bench)
+{
+    static struct WriteBenchTable {
+        char const* label;
+        TDA8425_Reg address;
+        TDA8425_Register values[2];
+    } const WRITE_BENCH_TABLE[] =
+    {
+        { "VL", TDA8425_Reg_VL, { 0x3C, 0x30 } },
+        { "VR", TDA8425_Reg_VR, { 0x3C, 0x30 } },
+        { "BA", TDA8425_Reg_BA, { 0x06, 0x0B } },
+        { "TR", TDA8425_Reg_TR, { 0x06, 0x0A } },
+        { "PP", TDA8425_Reg_PP, { 0x00, 0x01 } },
+        { "SF", TDA8425_Reg_SF, { 0x0E, 0x1E } },  // linear / spatial
+        { NULL, (TDA8425_Reg)0, { 0x00, 0x00 } }
+    };
+    int first = 1;
+
+    printf("  \"write\": [");
+    ProcessBench_Setup(bench, TDA8425_Mode_PseudoStereo, 1, 1);
+    for (int r = 0; WRITE_BENCH_TABLE[r].label; ++r) {
+        bench->address = (TDA8425_Address)WRITE_BENCH_TABLE[r].address;
+        bench->values[0] = WRITE_BENCH_TABLE[r].values[0];
+        bench->values[1] = WRITE_BENCH_TABLE[r].values[1];
+        double write = Bench_Measure(WriteTask, bench);
+        double refresh = Bench_Measure(WriteRefreshTask, bench);
+        TDA8425_Chip_Write(&bench->chip, bench->address, bench->values[0]);
+
+        printf("%s\n    { \"register\": \"%s\", \"write_ns\": %.3f, \"write_refresh_ns\": %.3f }",
+               (first ? "" : ","), WRITE_BENCH_TABLE[r].label, write * 1e9, refresh * 1e9);
+        first = 0;
+    }
+    ProcessBench_Cleanup(bench);
+    printf("\n  ],\n");
+}
+
+
+// ============================================================================
+
+static int RunFormatBench(void)
+{
+    size_t const count = BENCH_FRAMES * 4;
+    int first = 1;
+
+    printf("  \"formats\": [");
+    for (SampleFormat const* format = SAMPLE_FORMAT_TABLE; format->label; ++format) {
+        double decode;
+        double encode;
+        if (!SampleFormat_Measure(format, count, g_min_time, &decode, &encode)) {
+            return 0;
+        }
+        printf("%s\n    { \"format\": \"%s\", \"decode_gbps\": %.3f, \"encode_gbps\": %.3f }",
+               (first ? "" : ","), format->label, decode * 1e-9, encode * 1e-9);
+        first = 0;
+    }
+    printf("\n  ],\n");
+    return 1;
+}
+
+
+// ============================================================================
+
+// Runs the pipe on a generated signal, and parses its statistics; the signal
+// is lengthened until the run takes at least the minimum time
+static void RunPipeBench(char const* path)
+{
+    char command[4096];
+    char line[256];
+    double frame_rate = -1;
+    double realtime = -1;
+    double duration = g_min_time;  // first guess: real time
+
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        double elapsed = -1;
+        frame_rate = -1;
+        realtime = -1;
+
+        snprintf(command, sizeof(command),
+                 "\"%s\" -c 2 -f S16_LE -r %.0f --generate noise --duration %.6f --null-output --stats 2>&1",
+                 path, g_rate, duration);
+        FILE* stream = popen(command, "r");
+        if (stream) {
+            while (fgets(line, (int)sizeof(line), stream)) {
+                sscanf(line, "Frame rate: %lf", &frame_rate);
+                sscanf(line, "Realtime: %lf", &realtime);
+                sscanf(line, "Elapsed: %lf", &elapsed);
+            }
+            if (pclose(stream)) {
+                frame_rate = -1;
+            }
+        }
+        if (frame_rate < 0 || realtime < 0 || elapsed >= g_min_time) {
+            break;
+        }
+
+        // Aim a bit beyond the minimum time, growing 2x to 16x
+        double factor = (elapsed > 0 ? g_min_time / elapsed * 1.25 : 16);
+        duration *= (factor < 2 ? 2 : factor > 16 ? 16 : factor);
+    }
+
+    if (frame_rate < 0 || realtime < 0) {
+        printf("  \"pipe\": null\n");
+    }
+    else {
+        printf("  \"pipe\": { \"format\": \"S16_LE\", \"channels\": 2, "
+               "\"frames_per_second\": %.0f, \"realtime\": %.2f }\n", frame_rate, realtime);
+    }
+}
+
+
+// ============================================================================
+
+int main(int argc, char const* argv[])
+{
+    char const* pipe_path = "./TDA8425_pipe";
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            puts(USAGE);
+            return 0;
+        }
+        if (i >= argc - 1) {
+            fprintf(stderr, "Expecting binary argument: %s\n", argv[i]);
+            return 1;
+        }
+        else if (!strcmp(argv[i], "--min-time")) {
+            g_min_time = strtod(argv[++i], NULL);
+            if (!(g_min_time > 0)) {
+                fprintf(stderr, "Invalid minimum time: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--pipe")) {
+            pipe_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-r") || !strcmp(argv[i], "--rate")) {
+            g_rate = strtod(argv[++i], NULL);
+            if (!(g_rate > 0)) {
+                fprintf(stderr, "Invalid rate: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    ProcessBench* process_bench = (ProcessBench*)malloc(sizeof(ProcessBench));
+    if (!process_bench) {
+        perror("malloc()");
+        return 1;
+    }
+
+    printf("{\n");
+    printf("  \"version\": \"%s\",\n", TDA8425_GetVersion());
+    printf("  \"float\": \"%s\",\n", (sizeof(TDA8425_Float) == sizeof(float) ? "float" : "double"));
+    printf("  \"block_size\": %d,\n", (int)TDA8425_BLOCK_SIZE);
+    printf("  \"rate\": %.0f,\n", g_rate);
+    RunProcessBench(process_bench);
+    RunWriteBench(process_bench);
+    if (!RunFormatBench()) {
+        perror("malloc()");
+        free(process_bench);
+        return 1;
+    }
+    RunPipeBench(pipe_path);
+    printf("}\n");
+
+    free(process_bench);
+    return 0;
+}
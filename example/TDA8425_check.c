@@ -0,0 +1,455 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "TDA8425_emu.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "events.h"
+#include "generator.h"
+
+
+static char const* USAGE = ("\
+TDA8425_check (c) 2020-2024, Andrea Zoppi. All rights reserved.\n\
+\n\
+This program checks the accuracy of candidate processing engines against\n\
+the reference TDA8425_Chip_Process(), run side by side on the same chip\n\
+settings, input signals, and register writes.\n\
+For each configuration, it prints the maximum absolute error of the\n\
+outputs, the SNR of the reference against the error, and the first frame\n\
+where the error exceeds the tolerance of the engine.\n\
+The exit code is 1 if any configuration exceeds its tolerance.\n\
+\n\
+\n\
+USAGE:\n\
+  check [OPTION]...\n\
+\n\
+\n\
+OPTION:\n\
+\n\
+-e, --engine ENGINE\n\
+    Checks only the given engine; default: all.\n\
+    See ENGINE table.\n\
+\n\
+--frames COUNT\n\
+    Frames per configuration; default: 48000.\n\
+\n\
+-h, --help\n\
+    Prints this help message and quits.\n\
+\n\
+-r, --rate RATE\n\
+    Sample rate [Hz]; default: 48000.\n\
+\n\
+--seed SEED\n\
+    Seed of the random register writes; default: 1.\n\
+\n\
+--writes COUNT\n\
+    Random register write sequences per signal; default: 4.\n\
+\n\
+\n\
+ENGINE:\n\
+\n\
+| Name    | Tolerance [dB] | Description                             |\n\
+|---------|----------------|-----------------------------------------|\n\
+| block   |           -150 | TDA8425_Chip_ProcessBlock()             |\n\
+| chunked |           -120 | TDA8425_Chip_ProcessChunked(), 4 chunks |\n\
+\n\
+Errors and tolerances are relative to the full scale, or to the peak of the\n\
+reference output if louder.\n\
+\n\
+\n\
+CONFIGURATIONS:\n\
+\n\
+Each SIGNAL of TDA8425_pipe --generate, on all the four inputs, is checked\n\
+with static registers for each stereo mode, with and without T-filter and\n\
+DC removal, and then with --writes sequences of random register writes.\n\
+");
+
+
+// ============================================================================
+
+typedef void (*CheckEngine_Process)(TDA8425_Chip* chip, TDA8425_Chip_Process_Data* frames, TDA8425_Index count);
+
+typedef struct CheckEngine {
+    char const* label;
+    CheckEngine_Process process;
+    double tolerance;  // [dB], relative to the full scale or the reference peak
+} CheckEngine;
+
+
+static void Check_ProcessBlock(TDA8425_Chip* chip, TDA8425_Chip_Process_Data* frames, TDA8425_Index count)
+{
+    TDA8425_Chip_ProcessBlock(chip, frames, count);
+}
+
+
+static void Check_ForEachSerial(void* context, TDA8425_Task task, void* arg, TDA8425_Index count)
+{
+    (void)context;
+    for (TDA8425_Index index = 0; index < count; ++index) {
+        task(arg, index);
+    }
+}
+
+
+static void Check_ProcessChunked(TDA8425_Chip* chip, TDA8425_Chip_Process_Data* frames, TDA8425_Index count)
+{
+    if (!TDA8425_Chip_ProcessChunked(chip, frames, count, 4, Check_ForEachSerial, NULL)) {
+        TDA8425_Chip_ProcessBlock(chip, frames, count);  // out of memory, as per the pipe
+    }
+}
+
+
+// Candidate engines; new kernels are checked by adding them here
+static CheckEngine const CHECK_ENGINE_TABLE[] =
+{
+    { "block",   Check_ProcessBlock,   -150 },
+    { "chunked", Check_ProcessChunked, -120 },
+    { NULL,      NULL,                    0 }
+};
+
+
+static char const* const MODE_LABELS[TDA8425_Mode_Count] = { "mono", "linear", "pseudo", "spatial" };
+
+
+// ============================================================================
+
+typedef struct CheckConfig {
+    GeneratorKind signal;
+    TDA8425_Register sf;  // initial SF register
+    unsigned long seed;   // random writes, if not 0
+} CheckConfig;
+
+typedef struct CheckResult {
+    double peak;
+    double max_error;
+    double relative_error;  // [dB], of the full scale or the reference peak
+    double signal_energy;
+    double error_energy;
+    long long first_divergent;  // -1 if none
+} CheckResult;
+
+typedef struct Check {
+    TDA8425_Float rate;
+    TDA8425_Index frames;
+    TDA8425_Chip reference;
+    TDA8425_Chip candidate;
+    TDA8425_Chip_Process_Data* inputs;
+    TDA8425_Chip_Process_Data* outputs;
+    TDA8425_Float* samples;
+    Event* writes;
+    size_t write_count;
+} Check;
+
+
+// Linear congruential generator, as per the random register writes
+static unsigned long Check_Random(unsigned long* seed)
+{
+    *seed = (*seed * 1103515245ul + 12345ul) & 0x7FFFFFFFul;
+    return *seed >> 8;
+}
+
+
+// Random writes of any register, about every thousand frames; SF keeps the
+// T-filter and DC removal bits of the configuration
+static void Check_RandomWrites(Check* self, CheckConfig const* config)
+{
+    static TDA8425_Reg const ADDRESSES[] = {
+        TDA8425_Reg_VL, TDA8425_Reg_VR, TDA8425_Reg_BA, TDA8425_Reg_TR, TDA8425_Reg_PP, TDA8425_Reg_SF
+    };
+    TDA8425_Register const fixed = (TDA8425_Register)((1u << TDA8425_Reg_SF_TF) | (1u << TDA8425_Reg_SF_DC));
+    unsigned long seed = config->seed;
+    TDA8425_Index frame = 0;
+
+    self->write_count = 0;
+    if (!seed) {
+        return;
+    }
+    for (;;) {
+        frame += (TDA8425_Index)(Check_Random(&seed) % 2000u);
+        if (frame >= self->frames) {
+            break;
+        }
+        Event* write = &self->writes[self->write_count++];
+        write->frame = (uint64_t)frame;
+        write->address = (TDA8425_Address)ADDRESSES[Check_Random(&seed) % (sizeof(ADDRESSES) / sizeof(ADDRESSES[0]))];
+        write->data = (TDA8425_Register)Check_Random(&seed);
+
+        if (write->address == TDA8425_Reg_BA || write->address == TDA8425_Reg_TR) {
+            write->data &= (TDA8425_Register)TDA8425_Tone_Data_Mask;
+        }
+        else if (write->address == TDA8425_Reg_SF) {
+            write->data = (TDA8425_Register)((write->data & ~fixed) | (config->sf & fixed));
+        }
+    }
+}
+
+
+static void Check_SetupChip(Check const* self, TDA8425_Chip* chip, CheckConfig const* config)
+{
+    TDA8425_Chip_Ctor(chip);
+    TDA8425_Chip_Setup(chip, self->rate, TDA8425_Pseudo_C1_Table[0], TDA8425_Pseudo_C2_Table[0],
+                       TDA8425_Tfilter_Mode_Disabled);
+    TDA8425_Chip_Reset(chip);
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_VL, (TDA8425_Register)TDA8425_Volume_Data_Unity);
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_VR, (TDA8425_Register)TDA8425_Volume_Data_Unity);
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_BA, (TDA8425_Register)(TDA8425_Tone_Data_Unity + 2));
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_TR, (TDA8425_Register)(TDA8425_Tone_Data_Unity - 2));
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_SF, config->sf);
+    TDA8425_Chip_Start(chip);
+}
+
+
+// Runs the reference and the candidate on a configuration, and compares them
+static void Check_Run(Check* self, CheckEngine const* engine, CheckConfig const* config, CheckResult* result)
+{
+    TDA8425_Index const frames = self->frames;
+    Generator generator;
+
+    Generator_Init(&generator, config->signal, TDA8425_Source_Count * TDA8425_Stereo_Count, (double)self->rate,
+                   (uint64_t)frames);
+    Generator_Render(&generator, self->samples, frames);
+    for (TDA8425_Index i = 0; i < frames; ++i) {
+        memcpy(self->inputs[i].inputs, &self->samples[i * TDA8425_Source_Count * TDA8425_Stereo_Count],
+               sizeof(self->inputs[i].inputs));
+    }
+    memcpy(self->outputs, self->inputs, frames * sizeof(TDA8425_Chip_Process_Data));
+    Check_RandomWrites(self, config);
+
+    Check_SetupChip(self, &self->reference, config);
+    Check_SetupChip(self, &self->candidate, config);
+
+    // Spans between writes
+    size_t next = 0;
+    for (TDA8425_Index done = 0; done < frames; ) {
+        TDA8425_Index end = frames;
+        for (; next < self->write_count && self->writes[next].frame <= (uint64_t)done; ++next) {
+            Event const* write = &self->writes[next];
+            TDA8425_Chip_Write(&self->reference, write->address, write->data);
+            TDA8425_Chip_Write(&self->candidate, write->address, write->data);
+        }
+        if (next < self->write_count) {
+            end = (TDA8425_Index)self->writes[next].frame;
+        }
+
+        for (TDA8425_Index i = done; i < end; ++i) {
+            TDA8425_Chip_Process(&self->reference, &self->inputs[i]);
+        }
+        engine->process(&self->candidate, &self->outputs[done], end - done);
+        done = end;
+    }
+
+    TDA8425_Chip_Stop(&self->candidate);
+    TDA8425_Chip_Dtor(&self->candidate);
+    TDA8425_Chip_Stop(&self->reference);
+    TDA8425_Chip_Dtor(&self->reference);
+
+    // Tolerance relative to the reference peak, for gains above full scale
+    memset(result, 0, sizeof(*result));
+    result->first_divergent = -1;
+    for (TDA8425_Index i = 0; i < frames; ++i) {
+        for (int c = 0; c < TDA8425_Stereo_Count; ++c) {
+            double expected = fabs((double)self->inputs[i].outputs[c]);
+            if (result->peak < expected) {
+                result->peak = expected;
+            }
+        }
+    }
+    double const scale = (result->peak > 1 ? result->peak : 1);
+    double const tolerance = pow(10, engine->tolerance / 20) * scale;
+
+    for (TDA8425_Index i = 0; i < frames; ++i) {
+        for (int c = 0; c < TDA8425_Stereo_Count; ++c) {
+            double expected = (double)self->inputs[i].outputs[c];
+            double error = fabs((double)self->outputs[i].outputs[c] - expected);
+            result->signal_energy += expected * expected;
+            result->error_energy += error * error;
+            if (result->max_error < error || error != error) {
+                result->max_error = error;
+            }
+            if (result->first_divergent < 0 && !(error <= tolerance)) {
+                result->first_divergent = (long long)i;
+            }
+        }
+    }
+    result->relative_error = -HUGE_VAL;
+    if (result->max_error > 0) {
+        result->relative_error = 20 * log10(result->max_error / scale);
+    }
+}
+
+
+// ============================================================================
+
+int main(int argc, char const* argv[])
+{
+    char const* engine_label = NULL;
+    long writes = 4;
+    unsigned long seed = 1;
+    Check* self = (Check*)calloc(1, sizeof(Check));
+
+    if (!self) {
+        perror("calloc()");
+        return 1;
+    }
+    self->rate = 48000;
+    self->frames = 48000;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            puts(USAGE);
+            free(self);
+            return 0;
+        }
+        if (i >= argc - 1) {
+            fprintf(stderr, "Expecting binary argument: %s\n", argv[i]);
+            free(self);
+            return 1;
+        }
+        else if (!strcmp(argv[i], "-e") || !strcmp(argv[i], "--engine")) {
+            engine_label = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--frames")) {
+            long frames = strtol(argv[++i], NULL, 10);
+            if (frames < 1) {
+                fprintf(stderr, "Invalid frames: %s\n", argv[i]);
+                free(self);
+                return 1;
+            }
+            self->frames = (TDA8425_Index)frames;
+        }
+        else if (!strcmp(argv[i], "-r") || !strcmp(argv[i], "--rate")) {
+            self->rate = (TDA8425_Float)strtod(argv[++i], NULL);
+            if (!(self->rate > 0)) {
+                fprintf(stderr, "Invalid rate: %s\n", argv[i]);
+                free(self);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--seed")) {
+            seed = strtoul(argv[++i], NULL, 10);
+        }
+        else if (!strcmp(argv[i], "--writes")) {
+            writes = strtol(argv[++i], NULL, 10);
+            if (writes < 0) {
+                fprintf(stderr, "Invalid writes: %s\n", argv[i]);
+                free(self);
+                return 1;
+            }
+        }
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            free(self);
+            return 1;
+        }
+    }
+
+    int found = !engine_label;
+    for (int e = 0; engine_label && CHECK_ENGINE_TABLE[e].label; ++e) {
+        found |= !strcmp(engine_label, CHECK_ENGINE_TABLE[e].label);
+    }
+    if (!found) {
+        fprintf(stderr, "Unknown engine: %s\n", engine_label);
+        free(self);
+        return 1;
+    }
+
+    self->inputs = (TDA8425_Chip_Process_Data*)malloc(self->frames * sizeof(TDA8425_Chip_Process_Data));
+    self->outputs = (TDA8425_Chip_Process_Data*)malloc(self->frames * sizeof(TDA8425_Chip_Process_Data));
+    self->samples = ((TDA8425_Float*)
+                     malloc(self->frames * TDA8425_Source_Count * TDA8425_Stereo_Count * sizeof(TDA8425_Float)));
+    self->writes = (Event*)malloc((self->frames + 1) * sizeof(Event));
+    int failures = 0;
+    if (!self->inputs || !self->outputs || !self->samples || !self->writes) {
+        perror("malloc()");
+        failures = 1;
+        goto end;
+    }
+
+    printf("| Engine  | Signal  | Mode    | TF  | DC  | Writes | Max error | Error [dB] | SNR [dB] | First divergent | Result |\n");
+    printf("|---------|---------|---------|-----|-----|--------|-----------|------------|----------|-----------------|--------|\n");
+
+    for (CheckEngine const* engine = CHECK_ENGINE_TABLE; engine->label; ++engine) {
+        if (engine_label && strcmp(engine_label, engine->label)) {
+            continue;
+        }
+        for (int signal = Generator_None + 1; signal < Generator_Count; ++signal) {
+            long count = TDA8425_Mode_Count * 4 + writes;
+
+            for (long k = 0; k < count; ++k) {
+                CheckConfig config;
+                CheckResult result;
+                long variant = (k < TDA8425_Mode_Count * 4 ? k : (k - TDA8425_Mode_Count * 4) % 4);
+                int mode = (int)(variant / 4 % TDA8425_Mode_Count);
+                int tfilter = (int)(variant & 1);
+                int dcremoval = (int)((variant >> 1) & 1);
+
+                // T-filter and DC removal are enabled by clearing their SF bits
+                config.signal = (GeneratorKind)signal;
+                config.sf = (TDA8425_Register)(
+                    (TDA8425_Register)TDA8425_Selector_Stereo_1 |
+                    ((TDA8425_Register)mode << TDA8425_Reg_SF_STL) |
+                    (tfilter ? 0u : (1u << TDA8425_Reg_SF_TF)) |
+                    (dcremoval ? 0u : (1u << TDA8425_Reg_SF_DC))
+                );
+                config.seed = (k < TDA8425_Mode_Count * 4 ? 0 : seed + (unsigned long)k);
+
+                Check_Run(self, engine, &config, &result);
+                int failed = (result.first_divergent >= 0);
+                failures += failed;
+
+                double snr = HUGE_VAL;
+                if (result.error_energy > 0) {
+                    snr = 10 * log10(result.signal_energy / result.error_energy);
+                }
+                printf("| %-7s | %-7s | %-7s | %-3s | %-3s | %6lu | %9.3g | %10.1f | %8.1f | ",
+                       engine->label, GENERATOR_LABELS[signal], (config.seed ? "random" : MODE_LABELS[mode]),
+                       (tfilter ? "on" : "off"), (dcremoval ? "on" : "off"), (unsigned long)self->write_count,
+                       result.max_error, result.relative_error, snr);
+                if (result.first_divergent >= 0) {
+                    printf("%15lld | FAIL   |\n", result.first_divergent);
+                }
+                else {
+                    printf("%15s | ok     |\n", "-");
+                }
+            }
+        }
+    }
+    printf("\n%d configuration(s) failed\n", failures);
+
+end:
+    free(self->writes);
+    free(self->samples);
+    free(self->outputs);
+    free(self->inputs);
+    free(self);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,585 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE  // pthread_setaffinity_np()
+#endif
+
+#include "TDA8425_emu.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "clock.h"
+#include "generator.h"
+#include "thread.h"
+
+
+static char const* USAGE = ("\
+TDA8425_latency (c) 2020-2024, Andrea Zoppi. All rights reserved.\n\
+\n\
+This program measures the worst-case time of TDA8425_Chip_ProcessBlock(),\n\
+as called by an audio callback, for each buffer size of the FRAMES table.\n\
+It runs on a thread pinned to a CPU, applying register writes between\n\
+buffers, and prints the latency percentiles of each buffer size.\n\
+Each buffer processed later than the deadline is reported after the run,\n\
+telling whether it followed register writes, or it left subnormal values in\n\
+the outputs or in the filter states.\n\
+The exit code is 1 if any buffer misses its deadline.\n\
+\n\
+\n\
+USAGE:\n\
+  latency [OPTION]...\n\
+\n\
+\n\
+OPTION:\n\
+\n\
+--budget PERCENT\n\
+    Deadline, as a percentage of the buffer duration; default: 10.\n\
+\n\
+--cpu CPU\n\
+    CPU to pin the processing thread to; default: 0.\n\
+    Pinning is not supported on all the platforms.\n\
+\n\
+-d, --duration SECONDS\n\
+    Signal duration per buffer size [s]; default: 10.\n\
+\n\
+-g, --generate SIGNAL\n\
+    Input signal; default: noise. See TDA8425_pipe SIGNAL table.\n\
+    The signal is gated, half a second on and half a second off, so that\n\
+    the filter states decay towards subnormal values.\n\
+\n\
+-h, --help\n\
+    Prints this help message and quits.\n\
+\n\
+--reports COUNT\n\
+    Maximum missed deadlines reported per buffer size; default: 10.\n\
+\n\
+-r, --rate RATE\n\
+    Sample rate [Hz]; default: 48000.\n\
+\n\
+-w, --write-interval COUNT\n\
+    Buffers between random register writes; default: 4.\n\
+    Each write changes the bass, the treble, a volume, or the stereo mode.\n\
+\n\
+\n\
+FRAMES:\n\
+\n\
+32, 64, 128, 256, 512, 1024\n\
+");
+
+
+// ============================================================================
+
+#define LATENCY_SUB_BUCKETS  16   // per power of two, about 4% resolution
+#define LATENCY_OCTAVES      40   // up to about 18 minutes [ns]
+#define LATENCY_BUCKETS      (LATENCY_SUB_BUCKETS * LATENCY_OCTAVES)
+#define LATENCY_WARMUP       16   // buffers not measured
+
+#define LATENCY_SUBNORMAL_OUTPUTS  1
+#define LATENCY_SUBNORMAL_STATE    2
+
+static long const FRAMES_TABLE[] = { 32, 64, 128, 256, 512, 1024, 0 };
+
+typedef struct Histogram {
+    uint64_t buckets[LATENCY_BUCKETS];
+    uint64_t count;
+    uint64_t max;  // [ns]
+} Histogram;
+
+typedef struct LatencyMiss {
+    long buffer;
+    double elapsed;           // [s]
+    TDA8425_Address written;  // register written before, else ~0
+    int subnormals;           // LATENCY_SUBNORMAL_* flags
+} LatencyMiss;
+
+typedef struct Latency {
+    // Settings
+    double rate;
+    double duration;
+    double budget;
+    int cpu;
+    long write_interval;
+    long reports;
+    GeneratorKind signal;
+
+    // Current buffer size
+    long frames;
+    TDA8425_Chip chip;
+    TDA8425_Chip_Process_Data* buffers;
+    TDA8425_Float* samples;
+    long buffer_count;
+    long write_count;
+    long missed;
+    LatencyMiss* misses;  // first reports
+    int pinned;
+    Histogram histogram;
+} Latency;
+
+
+// Log-linear bucket of a time [ns]: exact below the sub-bucket count, then
+// a fixed number of sub-buckets per power of two
+static unsigned Histogram_Bucket(uint64_t value)
+{
+    if (value < LATENCY_SUB_BUCKETS) {
+        return (unsigned)value;
+    }
+    unsigned octave = 0;
+    while ((value >> octave) >= (2 * LATENCY_SUB_BUCKETS)) {
+        ++octave;
+    }
+    unsigned bucket = (octave + 1) * LATENCY_SUB_BUCKETS + (unsigned)((value >> octave) - LATENCY_SUB_BUCKETS);
+    return (bucket < LATENCY_BUCKETS) ? bucket : (LATENCY_BUCKETS - 1);
+}
+
+
+// Upper bound of a bucket [ns]
+static uint64_t Histogram_BucketLimit(unsigned bucket)
+{
+    if (bucket < LATENCY_SUB_BUCKETS) {
+        return bucket;
+    }
+    unsigned octave = bucket / LATENCY_SUB_BUCKETS - 1;
+    uint64_t base = (uint64_t)(bucket % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS);
+    return ((base + 1) << octave) - 1;
+}
+
+
+static void Histogram_Add(Histogram* self, uint64_t value)
+{
+    ++self->buckets[Histogram_Bucket(value)];
+    ++self->count;
+    if (self->max < value) {
+        self->max = value;
+    }
+}
+
+
+// Value at a quantile, as the upper bound of its bucket, clamped to the max
+static uint64_t Histogram_Quantile(Histogram const* self, double quantile)
+{
+    uint64_t rank = (uint64_t)ceil(quantile * (double)self->count);
+    uint64_t seen = 0;
+
+    if (rank < 1) {
+        rank = 1;
+    }
+    for (unsigned bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+        seen += self->buckets[bucket];
+        if (seen >= rank) {
+            uint64_t limit = Histogram_BucketLimit(bucket);
+            return (limit < self->max) ? limit : self->max;
+        }
+    }
+    return self->max;
+}
+
+
+// ============================================================================
+
+// Pins the calling thread to a CPU; returns 0 if unsupported or failed
+static int Latency_Pin(int cpu)
+{
+#if defined(__WINDOWS__)
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return !pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+    return 0;
+#endif
+}
+
+
+// Linear congruential generator, as per the random register writes
+static unsigned long Latency_Random(unsigned long* seed)
+{
+    *seed = (*seed * 1103515245ul + 12345ul) & 0x7FFFFFFFul;
+    return *seed >> 8;
+}
+
+
+// Applies a random write, as a game changing its settings; returns the
+// written address
+static TDA8425_Address Latency_RandomWrite(Latency* self, unsigned long* seed)
+{
+    TDA8425_Register sf = TDA8425_Chip_Read(&self->chip, (TDA8425_Address)TDA8425_Reg_SF);
+    TDA8425_Address address;
+    TDA8425_Register data;
+
+    switch (Latency_Random(seed) % 5u)
+    {
+    case 0:
+        address = (TDA8425_Address)TDA8425_Reg_BA;
+        data = (TDA8425_Register)(Latency_Random(seed) % TDA8425_Tone_Data_Count);
+        break;
+
+    case 1:
+        address = (TDA8425_Address)TDA8425_Reg_TR;
+        data = (TDA8425_Register)(Latency_Random(seed) % TDA8425_Tone_Data_Count);
+        break;
+
+    case 2:
+        address = (TDA8425_Address)TDA8425_Reg_VL;
+        data = (TDA8425_Register)(TDA8425_Volume_Data_Unity - Latency_Random(seed) % 16u);
+        break;
+
+    case 3:
+        address = (TDA8425_Address)TDA8425_Reg_VR;
+        data = (TDA8425_Register)(TDA8425_Volume_Data_Unity - Latency_Random(seed) % 16u);
+        break;
+
+    default:
+        address = (TDA8425_Address)TDA8425_Reg_SF;
+        data = (TDA8425_Register)((sf & ~(TDA8425_Mode_Mask << TDA8425_Reg_SF_STL)) |
+                                  ((Latency_Random(seed) % TDA8425_Mode_Count) << TDA8425_Reg_SF_STL));
+        break;
+    }
+    TDA8425_Chip_Write(&self->chip, address, data);
+    return address;
+}
+
+
+// Tells where subnormal values are: LATENCY_SUBNORMAL_* flags
+static int Latency_FindSubnormals(TDA8425_Chip const* chip, TDA8425_Chip_Process_Data const* buffer, long frames)
+{
+    TDA8425_Float state[TDA8425_State_Count];
+    int found = 0;
+
+    for (long i = 0; i < frames; ++i) {
+        for (int c = 0; c < TDA8425_Stereo_Count; ++c) {
+            if (fpclassify(buffer[i].outputs[c]) == FP_SUBNORMAL) {
+                found |= LATENCY_SUBNORMAL_OUTPUTS;
+            }
+        }
+    }
+
+    // Denormals build up in the filter states, while decaying
+    TDA8425_Chip_GetState(chip, state);
+    for (int k = 0; k < TDA8425_State_Count; ++k) {
+        if (fpclassify(state[k]) == FP_SUBNORMAL) {
+            found |= LATENCY_SUBNORMAL_STATE;
+        }
+    }
+    return found;
+}
+
+
+static void Latency_PrintMisses(Latency const* self)
+{
+    static char const* const SUBNORMAL_LABELS[] = { "no", "outputs", "state", "both" };
+    double const deadline = self->budget / 100 * (double)self->frames / self->rate;
+    long const count = (self->missed < self->reports) ? self->missed : self->reports;
+
+    for (long m = 0; m < count; ++m) {
+        LatencyMiss const* miss = &self->misses[m];
+        char const* write_label = "-";
+        switch (miss->written)
+        {
+        case TDA8425_Reg_VL: write_label = "VL"; break;
+        case TDA8425_Reg_VR: write_label = "VR"; break;
+        case TDA8425_Reg_BA: write_label = "BA"; break;
+        case TDA8425_Reg_TR: write_label = "TR"; break;
+        case TDA8425_Reg_SF: write_label = "SF"; break;
+        default: break;
+        }
+        printf("| %6ld | %8ld | %12.3f | %13.3f | %-5s | %-9s |\n", self->frames, miss->buffer,
+               miss->elapsed * 1e6, deadline * 1e6, write_label, SUBNORMAL_LABELS[miss->subnormals]);
+    }
+}
+
+
+// Processes all the buffers of the current size, as an audio callback would
+static THREAD_ROUTINE(Latency_Routine, arg)
+{
+    Latency* self = (Latency*)arg;
+    long const frames = self->frames;
+    double const deadline = self->budget / 100 * (double)frames / self->rate;
+    unsigned long seed = 1;
+
+    self->pinned = Latency_Pin(self->cpu);
+
+    for (long b = -LATENCY_WARMUP; b < self->buffer_count; ++b) {
+        long index = (b < 0) ? (b + LATENCY_WARMUP) : b;
+        TDA8425_Chip_Process_Data* buffer = &self->buffers[index * frames];
+        TDA8425_Address written = (TDA8425_Address)~0;
+
+        double start = Clock_Seconds();
+        if (self->write_interval > 0 && !(index % self->write_interval)) {
+            written = Latency_RandomWrite(self, &seed);
+        }
+        TDA8425_Chip_ProcessBlock(&self->chip, buffer, (TDA8425_Index)frames);
+        double elapsed = Clock_Seconds() - start;
+
+        if (b < 0) {
+            continue;
+        }
+        Histogram_Add(&self->histogram, (uint64_t)(elapsed * 1e9 + 0.5));
+        self->write_count += (written != (TDA8425_Address)~0);
+
+        if (elapsed > deadline) {
+            // Only recorded here, as stdio would delay the next buffers
+            if (self->missed < self->reports) {
+                LatencyMiss* miss = &self->misses[self->missed];
+                miss->buffer = b;
+                miss->elapsed = elapsed;
+                miss->written = written;
+                miss->subnormals = Latency_FindSubnormals(&self->chip, buffer, frames);
+            }
+            ++self->missed;
+        }
+    }
+    THREAD_RETURN;
+}
+
+
+// Fills the input buffers: the signal on all the four inputs, gated
+static void Latency_Render(Latency* self)
+{
+    long const total = self->buffer_count * self->frames;
+    long const half_second = (long)(self->rate / 2);
+    Generator generator;
+
+    Generator_Init(&generator, self->signal, TDA8425_Source_Count * TDA8425_Stereo_Count, self->rate,
+                   (uint64_t)total);
+    Generator_Render(&generator, self->samples, (size_t)total);
+
+    for (long i = 0; i < total; ++i) {
+        int gate = ((i / half_second) & 1) == 0;
+        TDA8425_Float const* frame = &self->samples[i * TDA8425_Source_Count * TDA8425_Stereo_Count];
+        for (int s = 0; s < TDA8425_Source_Count; ++s) {
+            for (int c = 0; c < TDA8425_Stereo_Count; ++c) {
+                self->buffers[i].inputs[s][c] = gate ? frame[s * TDA8425_Stereo_Count + c] : 0;
+            }
+        }
+    }
+}
+
+
+static void Latency_SetupChip(Latency* self)
+{
+    TDA8425_Chip* chip = &self->chip;
+
+    TDA8425_Chip_Ctor(chip);
+    TDA8425_Chip_Setup(chip, (TDA8425_Float)self->rate, TDA8425_Pseudo_C1_Table[0], TDA8425_Pseudo_C2_Table[0],
+                       TDA8425_Tfilter_Mode_Disabled);
+    TDA8425_Chip_Reset(chip);
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_VL, (TDA8425_Register)TDA8425_Volume_Data_Unity);
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_VR, (TDA8425_Register)TDA8425_Volume_Data_Unity);
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_BA, (TDA8425_Register)TDA8425_Tone_Data_Unity);
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_TR, (TDA8425_Register)TDA8425_Tone_Data_Unity);
+    // T-filter and DC removal enabled, as their bits are cleared
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_SF, (TDA8425_Register)TDA8425_Selector_Stereo_1);
+    TDA8425_Chip_Start(chip);
+}
+
+
+// ============================================================================
+
+int main(int argc, char const* argv[])
+{
+    Latency* self = (Latency*)calloc(1, sizeof(Latency));
+    int missed = 0;
+
+    if (!self) {
+        perror("calloc()");
+        return 1;
+    }
+    self->rate = 48000;
+    self->duration = 10;
+    self->budget = 10;
+    self->cpu = 0;
+    self->write_interval = 4;
+    self->reports = 10;
+    self->signal = Generator_Noise;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            puts(USAGE);
+            free(self);
+            return 0;
+        }
+        if (i >= argc - 1) {
+            fprintf(stderr, "Expecting binary argument: %s\n", argv[i]);
+            free(self);
+            return 1;
+        }
+        else if (!strcmp(argv[i], "--budget")) {
+            self->budget = strtod(argv[++i], NULL);
+            if (!(self->budget > 0)) {
+                fprintf(stderr, "Invalid budget: %s\n", argv[i]);
+                free(self);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--cpu")) {
+            self->cpu = atoi(argv[++i]);
+            if (self->cpu < 0 || self->cpu >= 64) {
+                fprintf(stderr, "Invalid CPU: %s\n", argv[i]);
+                free(self);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "-d") || !strcmp(argv[i], "--duration")) {
+            self->duration = strtod(argv[++i], NULL);
+            if (!(self->duration > 0)) {
+                fprintf(stderr, "Invalid duration: %s\n", argv[i]);
+                free(self);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "-g") || !strcmp(argv[i], "--generate")) {
+            self->signal = Generator_Find(argv[++i]);
+            if (self->signal == Generator_None) {
+                fprintf(stderr, "Unknown signal: %s\n", argv[i]);
+                free(self);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--reports")) {
+            self->reports = strtol(argv[++i], NULL, 10);
+            if (self->reports < 0) {
+                fprintf(stderr, "Invalid reports: %s\n", argv[i]);
+                free(self);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "-r") || !strcmp(argv[i], "--rate")) {
+            self->rate = strtod(argv[++i], NULL);
+            if (!(self->rate >= 2)) {
+                fprintf(stderr, "Invalid rate: %s\n", argv[i]);
+                free(self);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "-w") || !strcmp(argv[i], "--write-interval")) {
+            self->write_interval = strtol(argv[++i], NULL, 10);
+            if (self->write_interval < 0) {
+                fprintf(stderr, "Invalid write interval: %s\n", argv[i]);
+                free(self);
+                return 1;
+            }
+        }
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            free(self);
+            return 1;
+        }
+    }
+
+    long const max_frames = FRAMES_TABLE[sizeof(FRAMES_TABLE) / sizeof(FRAMES_TABLE[0]) - 2];
+    long const max_buffers = (long)ceil(self->duration * self->rate / (double)FRAMES_TABLE[0]);
+    self->buffers = ((TDA8425_Chip_Process_Data*)
+                     malloc((size_t)(max_buffers * FRAMES_TABLE[0] + max_frames) * sizeof(TDA8425_Chip_Process_Data)));
+    self->samples = ((TDA8425_Float*)
+                     malloc((size_t)(max_buffers * FRAMES_TABLE[0] + max_frames) *
+                            TDA8425_Source_Count * TDA8425_Stereo_Count * sizeof(TDA8425_Float)));
+    self->misses = (LatencyMiss*)malloc((size_t)(self->reports + 1) * sizeof(LatencyMiss));
+    if (!self->buffers || !self->samples || !self->misses) {
+        perror("malloc()");
+        free(self->misses);
+        free(self->samples);
+        free(self->buffers);
+        free(self);
+        return 1;
+    }
+
+    Histogram* histograms = (Histogram*)calloc(sizeof(FRAMES_TABLE) / sizeof(FRAMES_TABLE[0]), sizeof(Histogram));
+    long* write_counts = (long*)calloc(sizeof(FRAMES_TABLE) / sizeof(FRAMES_TABLE[0]), sizeof(long));
+    long* missed_counts = (long*)calloc(sizeof(FRAMES_TABLE) / sizeof(FRAMES_TABLE[0]), sizeof(long));
+    int pinned = 1;
+    if (!histograms || !write_counts || !missed_counts) {
+        perror("calloc()");
+        missed = 1;
+        goto end;
+    }
+
+    printf("Missed deadlines:\n\n");
+    printf("| Frames | Buffer   | Elapsed [us] | Deadline [us] | Write | Subnormal |\n");
+    printf("|--------|----------|--------------|---------------|-------|-----------|\n");
+
+    for (int f = 0; FRAMES_TABLE[f]; ++f) {
+        Thread thread;
+
+        self->frames = FRAMES_TABLE[f];
+        self->buffer_count = (long)ceil(self->duration * self->rate / (double)self->frames);
+        self->write_count = 0;
+        self->missed = 0;
+        memset(&self->histogram, 0, sizeof(self->histogram));
+        Latency_Render(self);
+        Latency_SetupChip(self);
+
+        if (!Thread_Start(&thread, Latency_Routine, self)) {
+            fprintf(stderr, "Cannot start the processing thread\n");
+            missed = 1;
+            goto end;
+        }
+        Thread_Join(&thread);
+        Latency_PrintMisses(self);
+        TDA8425_Chip_Stop(&self->chip);
+        TDA8425_Chip_Dtor(&self->chip);
+
+        pinned &= self->pinned;
+        histograms[f] = self->histogram;
+        write_counts[f] = self->write_count;
+        missed_counts[f] = self->missed;
+        missed |= (self->missed > 0);
+    }
+
+    printf("\nLatency, %s on CPU %d:\n\n", (pinned ? "pinned" : "not pinned"), self->cpu);
+    printf("| Frames | Buffers  | Writes   | p50 [us] | p99 [us] | p99.9 [us] | Max [us] | Deadline [us] | Missed |\n");
+    printf("|--------|----------|----------|----------|----------|------------|----------|---------------|--------|\n");
+
+    for (int f = 0; FRAMES_TABLE[f]; ++f) {
+        Histogram const* histogram = &histograms[f];
+        double deadline = self->budget / 100 * (double)FRAMES_TABLE[f] / self->rate;
+
+        printf("| %6ld | %8llu | %8ld | %8.3f | %8.3f | %10.3f | %8.3f | %13.3f | %6ld |\n",
+               FRAMES_TABLE[f], (unsigned long long)histogram->count, write_counts[f],
+               (double)Histogram_Quantile(histogram, 0.5) * 1e-3,
+               (double)Histogram_Quantile(histogram, 0.99) * 1e-3,
+               (double)Histogram_Quantile(histogram, 0.999) * 1e-3,
+               (double)histogram->max * 1e-3, deadline * 1e6, missed_counts[f]);
+    }
+
+end:
+    free(missed_counts);
+    free(write_counts);
+    free(histograms);
+    free(self->misses);
+    free(self->samples);
+    free(self->buffers);
+    free(self);
+    return missed ? 1 : 0;
+}
@@ -26,6 +26,10 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L  // clock_gettime(), fileno(), read(), write()
+#endif
+
 #include "TDA8425_emu.h"
 
 #include <errno.h>
@@ -35,10 +39,20 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdlib.h>
 #include <string.h>
 
-#include "endian.h"
+#include "clock.h"
+#include "events.h"
+#include "file_map.h"
+#include "generator.h"
+#include "sample_format.h"
+#include "thread.h"
+#include "uring.h"
+#include "wave.h"
 
 #ifdef __WINDOWS__
 #include <io.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 
@@ -48,10 +62,11 @@ TDA8425_pipe (c) 2020-2024, Andrea Zoppi. All rights reserved.\n\
 This program emulates a TDA8425 Hi - fi stereo audio processor, made by\n\
 Philips Semiconductors.\n\
 It reads a sample stream from standard input, processes data, and writes\n\
-to the standard output.\n\
+to the standard output, unless files are given via --input and --output.\n\
 In case of multiple input channels, samples are interleaved. The format is\n\
-as specified by the --format option.\n\
-The output is always stereo, with the same sample format as per the input.\n\
+as specified by the --format option, unless read from a WAV header.\n\
+Input channels are routed to one or more emulated chips, see --route.\n\
+The output is stereo per chip, with the same sample format as per the input.\n\
 \n\
 \n\
 USAGE:\n\
@@ -64,13 +79,60 @@ OPTION (evaluated as per command line argument order):\n\
     Bass gain [dB]; default: 0.\n\
     Must belong to the possible bass gains, see DECIBEL_BASS.\n\
 \n\
+--batch MANIFEST\n\
+    Runs the jobs of a manifest file on the --jobs workers, and prints a\n\
+    per-job status and timing summary.\n\
+    Each line holds INPUT OUTPUT [OPTION]..., where the options follow\n\
+    those of the command line; \"double quotes\" and # comments allowed.\n\
+    Inputs and outputs must be files. Workers reuse their chips, so that\n\
+    the coefficients of the same static settings are not computed again.\n\
+    Not with --generate, --input, --io-uring, --output, --record,\n\
+    --segmented, nor --sweep.\n\
+\n\
+--block-size FRAMES\n\
+    Number of frames per pipeline block; default: 4096.\n\
+    Reading and decoding, processing, and encoding and writing run as\n\
+    three pipelined threads, passing whole blocks to each other.\n\
+\n\
+--buffer-size BYTES\n\
+    Block size as the size of its input buffer [B], instead of frames.\n\
+    Rounded down to whole frames, with at least one frame.\n\
+\n\
 -c, --channels COUNT\n\
     Number of input channels; default: 1, max: 32.\n\
 \n\
+--chip INDEX\n\
+    Applies the following register options only to the chip of the given\n\
+    0-based INDEX, or to all of them if \"all\" (default).\n\
+\n\
+--chips COUNT\n\
+    Number of emulated chips; default: 1, max: 16.\n\
+    Input channels are split into COUNT consecutive groups of up to 4\n\
+    channels, each feeding A1, B1, A2, B2 of its own chip.\n\
+\n\
+--events FILE\n\
+    Register writes to apply while streaming, at given frame indices.\n\
+    The high nibble of the register address selects the chip.\n\
+    Binary files start with the TDA8425E magic, followed by 10-byte\n\
+    records: frame index (64-bit little-endian), address, value.\n\
+    Text files hold one write per line: frame index, register label\n\
+    (VL, VR, BA, TR, SF) or address, and [0x]HEX value; # comments.\n\
+    Writes must be sorted by frame index; not for --segmented.\n\
+\n\
+--duration SECONDS\n\
+    Duration of the --generate signal [s]; default: 10.\n\
+\n\
 -f, --format FORMAT\n\
     Sample format name; default: U8.\n\
     See FORMAT table.\n\
 \n\
+--generate SIGNAL\n\
+    Synthesizes the input in-process, instead of reading it, so that\n\
+    the DSP can be measured without I/O; no decoding is involved.\n\
+    Every input channel gets the same signal, except for independent\n\
+    noise; --format and --rate still apply. Not for --segmented.\n\
+    See SIGNAL table.\n\
+\n\
 -m, --mode MODE\n\
     Stereo mode; default: linear.\n\
     See MODE table.\n\
@@ -81,6 +143,59 @@ OPTION (evaluated as per command line argument order):\n\
 -h, --help\n\
     Prints this help message and quits.\n\
 \n\
+--format-benchmark\n\
+    Prints the decoding and encoding speed of each FORMAT, in GB/s of\n\
+    stream data, and quits.\n\
+\n\
+-i, --input FILE\n\
+    Input file, memory-mapped for sequential reading if a regular file,\n\
+    else read as a stream (e.g. a FIFO); default: standard input.\n\
+\n\
+--input-container CONTAINER\n\
+    Input container; default: auto.\n\
+    A WAV header sets --format, --rate, and --channels.\n\
+    See CONTAINER table.\n\
+\n\
+--io-uring\n\
+    Streams standard input and output via io_uring under Linux, with the\n\
+    reads and writes of all the blocks in flight queued into registered\n\
+    buffers, and the DSP on a single thread; many requests are in flight\n\
+    for regular files, one per direction for pipes. Falls back to the\n\
+    reader and writer threads if not available.\n\
+\n\
+-j, --jobs COUNT\n\
+    Number of worker threads; default: 1, max: 64.\n\
+    Multiple chips are processed in parallel. A single chip is processed\n\
+    in parallel in time: the stream is split into chunks, rendered in\n\
+    parallel, and chained exactly via state transition matrices.\n\
+\n\
+--latency MILLISECONDS\n\
+    Latency target for live streaming [ms]; disabled by default.\n\
+    Shrinks blocks so that the frames queued in the pipeline stay within\n\
+    the target, e.g. when piping into aplay.\n\
+\n\
+-o, --output FILE\n\
+    Output file; default: standard output.\n\
+    If the input is a file too, the output file is sized in advance and\n\
+    memory-mapped, so that samples are encoded directly into its pages.\n\
+\n\
+--null-output\n\
+    Discards the output after encoding, instead of writing it.\n\
+\n\
+--output-container CONTAINER\n\
+    Output container; default: auto, same as the input.\n\
+    A WAV header is back-patched with the final sizes when the output is\n\
+    seekable, otherwise its sizes are left unknown for streaming.\n\
+    See CONTAINER table.\n\
+\n\
+--overlap FRAMES\n\
+    Warm-up frames before each segment of --segmented; default: 0 (auto).\n\
+    Automatically, the shortest one where the tails of the impulse\n\
+    responses sum up below --overlap-error; max: 10 seconds.\n\
+\n\
+--overlap-error ERROR\n\
+    Decay target for the automatic --overlap; default: 1e-7.\n\
+\n\
 --pseudo-c1 FARAD\n\
     Capacitance of pseudo C1 [F]; default: 15e-9.\n\
 \n\
@@ -91,6 +206,12 @@ OPTION (evaluated as per command line argument order):\n\
     Pseudo-stereo capacitance preset; default 1.\n\
     See PSEUDO_PRESET table.\n\
 \n\
+--record FILE\n\
+    Records the register writes applied to the chips into a binary --events\n\
+    FILE, replayable by --events with default registers: the initial\n\
+    registers at frame 0, then each write at its frame index.\n\
+    Not for --batch, --segmented, nor --sweep.\n\
+\n\
 --reg-BA [0x]HEX\n\
     Value of BA (bass) register; hexadecimal string.\n\
 \n\
@@ -110,9 +231,46 @@ OPTION (evaluated as per command line argument order):\n\
     Input source selector; default: S1.\n\
     See SELECTOR table.\n\
 \n\
+--route CHANNELS[:CHANNELS]...\n\
+    Explicit routing of 0-based input channels, one ':' group per chip,\n\
+    with up to 4 ',' channels per group, feeding A1, B1, A2, B2 in order;\n\
+    '-' feeds silence. Sets --chips; e.g. 0,1:2,3:4,5:6,7.\n\
+\n\
+--segmented\n\
+    Renders the --input file as one segment per --jobs worker, instead of\n\
+    streaming. Each segment is warmed up on the preceding --overlap\n\
+    frames, so that the result is approximate. Registers must be static,\n\
+    with a single chip.\n\
+\n\
+--segment-check\n\
+    Also renders serially, and prints the maximum deviation of the\n\
+    segmented render from it; needs memory for the whole output.\n\
+\n\
+--stats\n\
+    Prints throughput statistics to standard error, when finished: frame\n\
+    and sample rates, real-time factor at --rate, and the time spent by\n\
+    each pipeline stage; also the output peak and RMS levels of each chip,\n\
+    its clipped samples, and the headroom left after the volume and bass\n\
+    stages; also the hot-path counters of each chip, if built with\n\
+    TDA8425_USE_COUNTERS.\n\
+\n\
+--sweep AXIS[=VALUE[/VALUE]...][,AXIS...]\n\
+    Renders the whole input once per combination of register values,\n\
+    decoding it only once, with up to --jobs renderings in parallel.\n\
+    AXIS: bass, treble (decibel VALUEs; default: all), or mode (MODE\n\
+    labels; default: all); e.g. bass=-12/0/+15,mode=linear/spatial.\n\
+    The --output path gets a tag of the registers in place of %s, else\n\
+    before its extension; without --output, prints a table of the RMS\n\
+    and peak levels of each output channel instead.\n\
+    Not for --events or --segmented.\n\
+\n\
 --t-filter\n\
     Enables T-filter.\n\
 \n\
+--throughput\n\
+    Preset for offline processing, with large blocks and a deeper\n\
+    pipeline; disables --latency.\n\
+\n\
 -t, --treble DECIBEL_TREBLE\n\
     Treble gain [dB]; default: 0.\n\
     Must belong to the possible treble gains, see DECIBEL_TREBLE.\n\
@@ -140,6 +298,10 @@ FORMAT:\n\
 | U16_BE     |   16 | no   | big    |\n\
 | S16_LE     |   16 | yes  | little |\n\
 | S16_BE     |   16 | yes  | big    |\n\
+| S24_LE     | 24:32| yes  | little |\n\
+| S24_BE     | 24:32| yes  | big    |\n\
+| S24_3LE    |   24 | yes  | little |\n\
+| S24_3BE    |   24 | yes  | big    |\n\
 | U32_LE     |   32 | no   | little |\n\
 | U32_BE     |   32 | no   | big    |\n\
 | S32_LE     |   32 | yes  | little |\n\
@@ -150,6 +312,16 @@ FORMAT:\n\
 | FLOAT64_BE |   64 | yes  | big    |\n\
 \n\
 \n\
+CONTAINER:\n\
+\n\
+- auto: WAV if the input starts with a WAV header, else raw (default).\n\
+- raw:  headerless samples.\n\
+- wav:  RIFF WAV, WAVE_FORMAT_EXTENSIBLE, or RF64 beyond 4 GiB.\n\
+        Supports U8, S16_LE, S24_3LE, S32_LE, FLOAT_LE, and FLOAT64_LE;\n\
+        24-bit samples in 32-bit words are read as S32_LE, as they are\n\
+        stored left-aligned.\n\
+\n\
+\n\
 MODE:\n\
 \n\
 - linear:  linear stereo (default).\n\
@@ -167,6 +339,15 @@ PSEUDO_PRESET:\n\
 | 3 |     5.6 |      68 |\n\
 \n\
 \n\
+SIGNAL:\n\
+\n\
+- impulse: unit impulse at the first frame, then silence.\n\
+- noise:   white noise, sigma 0.1 as per gen_noise.py.\n\
+- sine:    1 kHz sine, -6 dBFS.\n\
+- sweep:   exponential sine sweep, -6 dBFS, from 20 Hz to 20 kHz, or\n\
+           to 45% of --rate if lower.\n\
+\n\
+\n\
 SELECTOR:\n\
 \n\
 - S1: Source 1, stereo (default).\n\
@@ -229,345 +410,47 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.\n\
 ");
 
 
-#if __BYTE_ORDER == __LITTLE_ENDIAN
-#define READ_LE( dst_, size_)  (fread ((dst_), (size_), 1, stdin ) == 1)
-#define WRITE_LE(src_, size_)  (fwrite((src_), (size_), 1, stdout) == 1)
-#define READ_BE( dst_, size_)  (fread ((dst_), 1, (size_), stdin ) == (size_))
-#define WRITE_BE(src_, size_)  (fwrite((src_), 1, (size_), stdout) == (size_))
-#elif __BYTE_ORDER == __BIG_ENDIAN
-#define READ_LE( dst_, size_)  (fread ((dst_), 1, (size_), stdin ) == (size_))
-#define WRITE_LE(src_, size_)  (fwrite((src_), 1, (size_), stdout) == (size_))
-#define READ_BE( dst_, size_)  (fread ((dst_), (size_), 1, stdin ) == 1)
-#define WRITE_BE(src_, size_)  (fwrite((src_), (size_), 1, stdout) == 1)
+#ifdef __WINDOWS__
+#define READ_FD( fd_, dst_, size_)  _read ((fd_), (dst_), (unsigned)(size_))
+#define WRITE_FD(fd_, src_, size_)  _write((fd_), (src_), (unsigned)(size_))
+#define SEEK_FD( fd_, offset_, whence_)  _lseeki64((fd_), (offset_), (whence_))
+#define CLOSE_FD(fd_)  _close(fd_)
 #else
-#error "Unsupported __BYTE_ORDER"
+#define READ_FD( fd_, dst_, size_)  read ((fd_), (dst_), (size_))
+#define WRITE_FD(fd_, src_, size_)  write((fd_), (src_), (size_))
+#define SEEK_FD( fd_, offset_, whence_)  lseek((fd_), (off_t)(offset_), (whence_))
+#define CLOSE_FD(fd_)  close(fd_)
 #endif
 
 
-long const MAX_INPUTS = (long)TDA8425_Source_Count * (long)TDA8425_Stereo_Count;
-long const MAX_OUTPUTS = (long)TDA8425_Stereo_Count;
-
-
-int ReadU8(TDA8425_Float* dst) {
-    int8_t src;
-    if (READ_LE(&src, sizeof(src))) {
-        src += INT8_MIN;
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT8_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadS8(TDA8425_Float* dst) {
-    int8_t src;
-    if (READ_LE(&src, sizeof(src))) {
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT8_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadU16L(TDA8425_Float* dst) {
-    int16_t src;
-    if (READ_LE(&src, sizeof(src))) {
-        src += INT16_MIN;
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT16_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadU16B(TDA8425_Float* dst) {
-    int16_t src;
-    if (READ_BE(&src, sizeof(src))) {
-        src += INT16_MIN;
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT16_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadS16L(TDA8425_Float* dst) {
-    int16_t src;
-    if (READ_LE(&src, sizeof(src))) {
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT16_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadS16B(TDA8425_Float* dst) {
-    int16_t src;
-    if (READ_BE(&src, sizeof(src))) {
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT16_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadU32L(TDA8425_Float* dst) {
-    int32_t src;
-    if (READ_LE(&src, sizeof(src))) {
-        src += INT32_MIN;
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT32_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadU32B(TDA8425_Float* dst) {
-    int32_t src;
-    if (READ_BE(&src, sizeof(src))) {
-        src += INT32_MIN;
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT32_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadS32L(TDA8425_Float* dst) {
-    int32_t src;
-    if (READ_LE(&src, sizeof(src))) {
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT32_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadS32B(TDA8425_Float* dst) {
-    int32_t src;
-    if (READ_BE(&src, sizeof(src))) {
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT32_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadU64L(TDA8425_Float* dst) {
-    int64_t src;
-    if (READ_LE(&src, sizeof(src))) {
-        src += INT64_MIN;
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT64_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadU64B(TDA8425_Float* dst) {
-    int64_t src;
-    if (READ_BE(&src, sizeof(src))) {
-        src += INT64_MIN;
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT64_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadS64L(TDA8425_Float* dst) {
-    int64_t src;
-    if (READ_LE(&src, sizeof(src))) {
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT64_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadS64B(TDA8425_Float* dst) {
-    int64_t src;
-    if (READ_BE(&src, sizeof(src))) {
-        *dst = (TDA8425_Float)src / -(TDA8425_Float)INT64_MIN;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadF32L(TDA8425_Float* dst) {
-    float src;
-    if (READ_LE(&src, sizeof(src))) {
-        *dst = (TDA8425_Float)src;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadF32B(TDA8425_Float* dst) {
-    float src;
-    if (READ_BE(&src, sizeof(src))) {
-        *dst = (TDA8425_Float)src;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadF64L(TDA8425_Float* dst) {
-    double src;
-    if (READ_LE(&src, sizeof(src))) {
-        *dst = (TDA8425_Float)src;
-        return 1;
-    }
-    return 0;
-}
-
-int ReadF64B(TDA8425_Float* dst) {
-    double src;
-    if (READ_BE(&src, sizeof(src))) {
-        *dst = (TDA8425_Float)src;
-        return 1;
-    }
-    return 0;
-}
-
-
-int WriteU8(TDA8425_Float src) {
-    double scaled = src * -(double)INT8_MIN;
-    int8_t dst = (int8_t)fmin(fmax(scaled, INT8_MIN), INT8_MAX);
-    dst -= INT8_MIN;
-    return WRITE_LE(&dst, sizeof(dst));
-}
-
-int WriteS8(TDA8425_Float src) {
-    double scaled = src * -(double)INT8_MIN;
-    int8_t dst = (int8_t)fmin(fmax(scaled, INT8_MIN), INT8_MAX);
-    return WRITE_LE(&dst, sizeof(dst));
-}
-
-int WriteU16L(TDA8425_Float src) {
-    double scaled = src * -(double)INT16_MIN;
-    int16_t dst = (int16_t)fmin(fmax(scaled, INT16_MIN), INT16_MAX);
-    dst -= INT16_MIN;
-    return WRITE_LE(&dst, sizeof(dst));
-}
-
-int WriteU16B(TDA8425_Float src) {
-    double scaled = src * -(double)INT16_MIN;
-    int16_t dst = (int16_t)fmin(fmax(scaled, INT16_MIN), INT16_MAX);
-    dst -= INT16_MIN;
-    return WRITE_BE(&dst, sizeof(dst));
-}
-
-int WriteS16L(TDA8425_Float src) {
-    double scaled = src * -(double)INT16_MIN;
-    int16_t dst = (int16_t)fmin(fmax(scaled, INT16_MIN), INT16_MAX);
-    return WRITE_LE(&dst, sizeof(dst));
-}
-
-int WriteS16B(TDA8425_Float src) {
-    double scaled = src * -(double)INT16_MIN;
-    int16_t dst = (int16_t)fmin(fmax(scaled, INT16_MIN), INT16_MAX);
-    return WRITE_BE(&dst, sizeof(dst));
-}
-
-int WriteU32L(TDA8425_Float src) {
-    double scaled = src * -(double)INT32_MIN;
-    int32_t dst = (int32_t)fmin(fmax(scaled, INT32_MIN), INT32_MAX);
-    dst -= INT32_MIN;
-    return WRITE_LE(&dst, sizeof(dst));
-}
-
-int WriteU32B(TDA8425_Float src) {
-    double scaled = src * -(double)INT32_MIN;
-    int32_t dst = (int32_t)fmin(fmax(scaled, INT32_MIN), INT32_MAX);
-    dst -= INT32_MIN;
-    return WRITE_BE(&dst, sizeof(dst));
-}
-
-int WriteS32L(TDA8425_Float src) {
-    double scaled = src * -(double)INT32_MIN;
-    int32_t dst = (int32_t)fmin(fmax(scaled, INT32_MIN), INT32_MAX);
-    return WRITE_LE(&dst, sizeof(dst));
-}
-
-int WriteS32B(TDA8425_Float src) {
-    double scaled = src * -(double)INT32_MIN;
-    int32_t dst = (int32_t)fmin(fmax(scaled, INT32_MIN), INT32_MAX);
-    return WRITE_BE(&dst, sizeof(dst));
-}
-
-int WriteU64L(TDA8425_Float src) {
-    double scaled = src * -(double)INT64_MIN;
-    int64_t dst = (int64_t)fmin(fmax(scaled, (double)INT64_MIN), (double)INT64_MAX);
-    dst -= INT64_MIN;
-    return WRITE_LE(&dst, sizeof(dst));
-}
-
-int WriteU64B(TDA8425_Float src) {
-    double scaled = src * -(double)INT64_MIN;
-    int64_t dst = (int64_t)fmin(fmax(scaled, (double)INT64_MIN), (double)INT64_MAX);
-    dst -= INT64_MIN;
-    return WRITE_BE(&dst, sizeof(dst));
-}
-
-int WriteS64L(TDA8425_Float src) {
-    double scaled = src * -(double)INT64_MIN;
-    int64_t dst = (int64_t)fmin(fmax(scaled, (double)INT64_MIN), (double)INT64_MAX);
-    return WRITE_LE(&dst, sizeof(dst));
-}
-
-int WriteS64B(TDA8425_Float src) {
-    double scaled = src * -(double)INT64_MIN;
-    int64_t dst = (int64_t)fmin(fmax(scaled, (double)INT64_MIN), (double)INT64_MAX);
-    return WRITE_BE(&dst, sizeof(dst));
-}
-
-int WriteF32L(TDA8425_Float src) {
-    float dst = (float)src;
-    return WRITE_LE(&dst, sizeof(dst));
-}
-
-int WriteF32B(TDA8425_Float src) {
-    float dst = (float)src;
-    return WRITE_BE(&dst, sizeof(dst));
-}
-
-int WriteF64L(TDA8425_Float src) {
-    double dst = (double)src;
-    return WRITE_LE(&dst, sizeof(dst));
-}
-
-int WriteF64B(TDA8425_Float src) {
-    double dst = (double)src;
-    return WRITE_BE(&dst, sizeof(dst));
-}
+// Per chip
+#define MAX_INPUTS   ((long)TDA8425_Source_Count * (long)TDA8425_Stereo_Count)
+#define MAX_OUTPUTS  ((long)TDA8425_Stereo_Count)
 
+#define MAX_CHANNELS 32
+#define MAX_CHIPS    (MAX_CHANNELS / MAX_OUTPUTS)
 
-typedef int (*STREAM_READER)(TDA8425_Float* dst);
-typedef int (*STREAM_WRITER)(TDA8425_Float src);
+#define MAX_JOBS 64
+long const JOB_FRAMES = 65536;
+long const MIN_PARALLEL_FRAMES = 256;  // shorter spans are not worth a handover
 
-struct FormatTable {
-    char const* label;
-    STREAM_READER reader;
-    STREAM_WRITER writer;
-} const FORMAT_TABLE[] =
-{
-    { "U8",         ReadU8,   WriteU8   },
-    { "S8",         ReadS8,   WriteS8   },
-    { "U16_LE",     ReadU16L, WriteU16L },
-    { "U16_BE",     ReadU16B, WriteU16B },
-    { "S16_LE",     ReadS16L, WriteS16L },
-    { "S16_BE",     ReadS16B, WriteS16B },
-    { "U32_LE",     ReadU32L, WriteU32L },
-    { "U32_BE",     ReadU32B, WriteU32B },
-    { "S32_LE",     ReadS32L, WriteS32L },
-    { "S32_BE",     ReadS32B, WriteS32B },
-    { "FLOAT_LE",   ReadF32L, WriteF32L },
-    { "FLOAT_BE",   ReadF32B, WriteF32B },
-    { "FLOAT64_LE", ReadF64L, WriteF64L },
-    { "FLOAT64_BE", ReadF64B, WriteF64B },
-    { NULL,         NULL,     NULL      }
-};
+long const DEFAULT_BLOCK_FRAMES = 4096;
+long const THROUGHPUT_BLOCK_FRAMES = 1L << 16;
+double const MAX_OVERLAP_SECONDS = 10;
 
 
 struct RegisterTable {
     char const* label;
     TDA8425_Reg value;
+    TDA8425_RegOrder order;
 } const REGISTER_TABLE[(int)TDA8425_RegOrder_Count + 1] =
 {
-    { "VL", TDA8425_Reg_VL },
-    { "VR", TDA8425_Reg_VR },
-    { "BA", TDA8425_Reg_BA },
-    { "TR", TDA8425_Reg_TR },
-    { "SF", TDA8425_Reg_SF },
-    { NULL, (TDA8425_Reg)0 }
+    { "VL", TDA8425_Reg_VL, TDA8425_RegOrder_VL },
+    { "VR", TDA8425_Reg_VR, TDA8425_RegOrder_VR },
+    { "BA", TDA8425_Reg_BA, TDA8425_RegOrder_BA },
+    { "TR", TDA8425_Reg_TR, TDA8425_RegOrder_TR },
+    { "SF", TDA8425_Reg_SF, TDA8425_RegOrder_SF },
+    { NULL, (TDA8425_Reg)0, (TDA8425_RegOrder)0 }
 };
 
 
@@ -586,18 +469,158 @@ struct SelectorTable {
 };
 
 
+typedef enum Container {
+    Container_Auto = 0,
+    Container_Raw,
+    Container_Wave
+} Container;
+
+struct ContainerTable {
+    char const* label;
+    Container value;
+} const CONTAINER_TABLE[] =
+{
+    { "auto", Container_Auto },
+    { "raw",  Container_Raw  },
+    { "wav",  Container_Wave },
+    { NULL,   (Container)0   }
+};
+
+
+typedef enum SweepAxis {
+    Sweep_Bass = 0,
+    Sweep_Treble,
+    Sweep_Mode,
+    Sweep_Count
+} SweepAxis;
+
+
 typedef struct Args {
     long channels;
-    STREAM_READER stream_reader;
-    STREAM_WRITER stream_writer;
+    long chips;
+    int routed;  // explicit --route
+    long routes[MAX_CHIPS][MAX_INPUTS];  // input channel per chip input, or -1
+    long chip_selected;  // for register options, or -1 for all
+    long jobs;
+    long buffer_size;
+    long block_frames;
+    double latency;
+    int throughput;
+    int segmented;
+    int segment_check;
+    long segment_overlap;
+    double segment_error;
+    int stats;
+    char const* input_path;
+    char const* output_path;
+    char const* events_path;
+    char const* record_path;
+    char const* batch_path;
+    GeneratorKind generator;
+    double duration;
+    int null_output;
+    int io_uring;
+    Container input_container;
+    Container output_container;
+    SampleFormat const* format;
     TDA8425_Float rate;
     TDA8425_Float pseudo_c1;
     TDA8425_Float pseudo_c2;
     TDA8425_Tfilter_Mode tfilter_mode;
-    TDA8425_Register regs[TDA8425_RegOrder_Count];
+    TDA8425_Register regs[MAX_CHIPS][TDA8425_RegOrder_Count];
+    long sweep_counts[Sweep_Count];  // 0 if not swept
+    TDA8425_Register sweep_values[Sweep_Count][TDA8425_Tone_Data_Count];
 } Args;
 
 
+// Sets the masked bits of a register, for the chips selected by --chip
+static void Args_SetRegister(Args* args, int order, TDA8425_Register mask, TDA8425_Register value)
+{
+    for (long c = 0; c < MAX_CHIPS; ++c) {
+        if (args->chip_selected < 0 || args->chip_selected == c) {
+            args->regs[c][order] = (TDA8425_Register)((args->regs[c][order] & ~mask) | (value & mask));
+        }
+    }
+}
+
+
+// Parses the --route groups; returns 0 on errors
+static int Args_ParseRoutes(Args* args, char const* text)
+{
+    long chips = 0;
+    long inputs = 0;
+
+    for (char const* ptr = text; ; ++ptr) {
+        if (!inputs) {
+            if (chips >= MAX_CHIPS) {
+                return 0;
+            }
+            for (long k = 0; k < MAX_INPUTS; ++k) {
+                args->routes[chips][k] = -1;
+            }
+            ++chips;
+        }
+        if (inputs >= MAX_INPUTS) {
+            return 0;
+        }
+        if (*ptr == '-') {
+            ++ptr;
+        }
+        else {
+            char* end;
+            long channel = strtol(ptr, &end, 10);
+            if (end == ptr || channel < 0 || channel >= MAX_CHANNELS) {
+                return 0;
+            }
+            args->routes[chips - 1][inputs] = channel;
+            ptr = end;
+        }
+        ++inputs;
+
+        if (*ptr == ':') {
+            inputs = 0;
+        }
+        else if (*ptr != ',') {
+            if (*ptr) {
+                return 0;
+            }
+            break;
+        }
+    }
+    args->chips = chips;
+    args->routed = 1;
+    return 1;
+}
+
+
+// Splits the input channels among the chips, unless routed explicitly;
+// returns 0 on errors
+static int Args_ResolveRoutes(Args* args)
+{
+    if (!args->routed) {
+        long group = (args->channels + args->chips - 1) / args->chips;
+        if (group > MAX_INPUTS) {
+            group = MAX_INPUTS;
+        }
+        for (long c = 0; c < args->chips; ++c) {
+            for (long k = 0; k < MAX_INPUTS; ++k) {
+                long channel = c * group + k;
+                args->routes[c][k] = ((k < group && channel < args->channels) ? channel : -1);
+            }
+        }
+    }
+    for (long c = 0; c < args->chips; ++c) {
+        for (long k = 0; k < MAX_INPUTS; ++k) {
+            if (args->routes[c][k] >= args->channels) {
+                fprintf(stderr, "Routed channel out of range: %ld\n", args->routes[c][k]);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+
 struct ModeTable {
     char const* label;
     TDA8425_Mode value;
@@ -611,37 +634,197 @@ struct ModeTable {
 };
 
 
-static int Run(Args const* args);
+// Parses the --sweep axes; returns 0 on errors
+static int Args_ParseSweep(Args* args, char const* text)
+{
+    static char const* const AXIS_LABELS[Sweep_Count] = { "bass", "treble", "mode" };
+
+    for (char const* ptr = text; ; ++ptr) {
+        size_t length = strcspn(ptr, "=,");
+        int axis;
+        for (axis = 0; axis < Sweep_Count; ++axis) {
+            if (strlen(AXIS_LABELS[axis]) == length && !strncmp(ptr, AXIS_LABELS[axis], length)) {
+                break;
+            }
+        }
+        if (axis >= Sweep_Count) {
+            return 0;
+        }
+        ptr += length;
+
+        long count = 0;
+        if (*ptr == '=') {
+            do {
+                TDA8425_Register value = 0;
+                int found = 0;
+                ++ptr;
+                length = strcspn(ptr, "/,");
+                if (axis == Sweep_Mode) {
+                    for (int j = 0; MODE_TABLE[j].label; ++j) {
+                        if (strlen(MODE_TABLE[j].label) == length && !strncmp(ptr, MODE_TABLE[j].label, length)) {
+                            value = (TDA8425_Register)MODE_TABLE[j].value;
+                            found = 1;
+                            break;
+                        }
+                    }
+                }
+                else {
+                    char* end;
+                    long db = strtol(ptr, &end, 10);
+                    signed char const* table = (axis == Sweep_Bass ? TDA8425_BassDecibel_Table :
+                                                TDA8425_TrebleDecibel_Table);
+                    for (int j = 0; end == ptr + length && length && j < TDA8425_Tone_Data_Count; ++j) {
+                        if (table[j] == db) {
+                            value = (TDA8425_Register)j;
+                            found = 1;
+                            break;
+                        }
+                    }
+                }
+                if (!found || count >= TDA8425_Tone_Data_Count) {
+                    return 0;
+                }
+                args->sweep_values[axis][count++] = value;
+                ptr += length;
+            } while (*ptr == '/');
+        }
+        else if (axis == Sweep_Mode) {
+            for (int j = 0; MODE_TABLE[j].label; ++j) {
+                args->sweep_values[axis][count++] = (TDA8425_Register)MODE_TABLE[j].value;
+            }
+        }
+        else {
+            for (int j = 0; j < TDA8425_Tone_Data_Count; ++j) {
+                args->sweep_values[axis][count++] = (TDA8425_Register)j;
+            }
+        }
+        args->sweep_counts[axis] = count;
+
+        if (*ptr != ',') {
+            return !*ptr;
+        }
+    }
+}
+
+
+static int Args_Parse(Args* args, int argc, char const* const argv[]);
+static int Run(Args* args);
+static int RunBatch(Args const* args);
+static int RunFormatBenchmark(void);
 
 
 int main(int argc, char const* argv[])
 {
     Args args;
     args.channels = 1;
-    args.stream_reader = ReadU8;
-    args.stream_writer = WriteU8;
+    args.chips = 1;
+    args.routed = 0;
+    args.chip_selected = -1;
+    args.jobs = 1;
+    args.buffer_size = 0;
+    args.block_frames = DEFAULT_BLOCK_FRAMES;
+    args.latency = 0;
+    args.throughput = 0;
+    args.segmented = 0;
+    args.segment_check = 0;
+    args.segment_overlap = 0;
+    args.segment_error = 1e-7;
+    args.stats = 0;
+    args.input_path = NULL;
+    args.output_path = NULL;
+    args.events_path = NULL;
+    args.record_path = NULL;
+    args.batch_path = NULL;
+    args.generator = Generator_None;
+    args.duration = 10;
+    args.null_output = 0;
+    args.io_uring = 0;
+    args.input_container = Container_Auto;
+    args.output_container = Container_Auto;
+    args.format = &SAMPLE_FORMAT_TABLE[0];
     args.rate = 44100;
     args.pseudo_c1 = TDA8425_Pseudo_C1_Table[0];
     args.pseudo_c2 = TDA8425_Pseudo_C2_Table[0];
     args.tfilter_mode = TDA8425_Tfilter_Mode_Disabled;
-    args.regs[TDA8425_RegOrder_VL] = (TDA8425_Register)TDA8425_Volume_Data_Unity;
-    args.regs[TDA8425_RegOrder_VR] = (TDA8425_Register)TDA8425_Volume_Data_Unity;
-    args.regs[TDA8425_RegOrder_BA] = (TDA8425_Register)TDA8425_Tone_Data_Unity;
-    args.regs[TDA8425_RegOrder_TR] = (TDA8425_Register)TDA8425_Tone_Data_Unity;
-    args.regs[TDA8425_RegOrder_SF] = (
-        (TDA8425_Register)TDA8425_Selector_Stereo_1 |
-        ((TDA8425_Register)TDA8425_Mode_LinearStereo << TDA8425_Reg_SF_STL)
-    );
-
-    for (int i = 1; i < argc; ++i) {
+    for (long c = 0; c < MAX_CHIPS; ++c) {
+        args.regs[c][TDA8425_RegOrder_VL] = (TDA8425_Register)TDA8425_Volume_Data_Unity;
+        args.regs[c][TDA8425_RegOrder_VR] = (TDA8425_Register)TDA8425_Volume_Data_Unity;
+        args.regs[c][TDA8425_RegOrder_BA] = (TDA8425_Register)TDA8425_Tone_Data_Unity;
+        args.regs[c][TDA8425_RegOrder_TR] = (TDA8425_Register)TDA8425_Tone_Data_Unity;
+        args.regs[c][TDA8425_RegOrder_SF] = (
+            (TDA8425_Register)TDA8425_Selector_Stereo_1 |
+            ((TDA8425_Register)TDA8425_Mode_LinearStereo << TDA8425_Reg_SF_STL)
+        );
+    }
+    for (int axis = 0; axis < Sweep_Count; ++axis) {
+        args.sweep_counts[axis] = 0;
+    }
+
+    int status = Args_Parse(&args, argc - 1, &argv[1]);
+    if (status >= 0) {
+        return status;
+    }
+
+#ifdef __WINDOWS__
+    _setmode(_fileno(stdin), O_BINARY);
+    if (errno) {
+        perror("_setmode(stdin)");
+        return 1;
+    }
+
+    _setmode(_fileno(stdout), O_BINARY);
+    if (errno) {
+        perror("_setmode(stdout)");
+        return 1;
+    }
+#endif  // __WINDOWS__
+
+    return Run(&args);
+}
+
+
+// Parses options into the arguments; returns the exit code if quitting, or
+// -1 to go on.
+static int Args_Parse(Args* args, int argc, char const* const argv[])
+{
+    for (int i = 0; i < argc; ++i) {
         // Unary arguments
         if (!strcmp(argv[i], "-h") ||
             !strcmp(argv[i], "--help")) {
             puts(USAGE);
             return 0;
         }
-        else if (!strcmp(argv[i], "--t-filter")) {
-            args.tfilter_mode = TDA8425_Tfilter_Mode_Enabled;
+        else if (!strcmp(argv[i], "--format-benchmark")) {
+            return RunFormatBenchmark();
+        }
+        else if (!strcmp(argv[i], "--throughput")) {
+            args->block_frames = THROUGHPUT_BLOCK_FRAMES;
+            args->latency = 0;
+            args->throughput = 1;
+            continue;
+        }
+        else if (!strcmp(argv[i], "--segmented")) {
+            args->segmented = 1;
+            continue;
+        }
+        else if (!strcmp(argv[i], "--segment-check")) {
+            args->segment_check = 1;
+            continue;
+        }
+        else if (!strcmp(argv[i], "--io-uring")) {
+            args->io_uring = 1;
+            continue;
+        }
+        else if (!strcmp(argv[i], "--null-output")) {
+            args->null_output = 1;
+            continue;
+        }
+        else if (!strcmp(argv[i], "--stats")) {
+            args->stats = 1;
+            continue;
+        }
+        else if (!strcmp(argv[i], "--t-filter")) {
+            args->tfilter_mode = TDA8425_Tfilter_Mode_Enabled;
             continue;
         }
 
@@ -655,7 +838,7 @@ int main(int argc, char const* argv[])
             int j;
             for (j = 0; j < TDA8425_Tone_Data_Count; ++j) {
                 if (TDA8425_BassDecibel_Table[j] == db) {
-                    args.regs[TDA8425_RegOrder_BA] = (TDA8425_Register)j;
+                    Args_SetRegister(args, TDA8425_RegOrder_BA, 0xFF, (TDA8425_Register)j);
                     break;
                 }
             }
@@ -664,28 +847,119 @@ int main(int argc, char const* argv[])
                 return 1;
             }
         }
+        else if (!strcmp(argv[i], "--batch")) {
+            args->batch_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--block-size")) {
+            args->block_frames = strtol(argv[++i], NULL, 10);
+            if (args->block_frames < 1) {
+                fprintf(stderr, "Invalid block size: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--buffer-size")) {
+            args->buffer_size = strtol(argv[++i], NULL, 10);
+            args->block_frames = 0;
+            if (args->buffer_size < 1) {
+                fprintf(stderr, "Invalid buffer size: %s\n", argv[i]);
+                return 1;
+            }
+        }
         else if (!strcmp(argv[i], "-c") || !strcmp(argv[i], "--channels")) {
-            args.channels = strtol(argv[++i], NULL, 10);
-            if (args.channels < 1) {
+            args->channels = strtol(argv[++i], NULL, 10);
+            if (args->channels < 1) {
                 fprintf(stderr, "Invalid channels: %s\n", argv[i]);
                 return 1;
             }
-            else if (args.channels > MAX_INPUTS) {
-                args.channels = MAX_INPUTS;
+            else if (args->channels > MAX_CHANNELS) {
+                args->channels = MAX_CHANNELS;
+            }
+        }
+        else if (!strcmp(argv[i], "--chip")) {
+            char* end;
+            args->chip_selected = strtol(argv[++i], &end, 10);
+            if (!strcmp(argv[i], "all")) {
+                args->chip_selected = -1;
+            }
+            else if (*end || end == argv[i] || args->chip_selected < 0 || args->chip_selected >= MAX_CHIPS) {
+                fprintf(stderr, "Invalid chip: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--chips")) {
+            args->chips = strtol(argv[++i], NULL, 10);
+            args->routed = 0;
+            if (args->chips < 1 || args->chips > MAX_CHIPS) {
+                fprintf(stderr, "Invalid chips: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--events")) {
+            args->events_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--record")) {
+            args->record_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--duration")) {
+            args->duration = strtod(argv[++i], NULL);
+            if (!(args->duration >= 0)) {
+                fprintf(stderr, "Invalid duration: %s\n", argv[i]);
+                return 1;
             }
         }
         else if (!strcmp(argv[i], "-f") || !strcmp(argv[i], "--format")) {
             char const* label = argv[++i];
+            args->format = SampleFormat_Find(label);
+            if (!args->format) {
+                fprintf(stderr, "Unknown format: %s\n", label);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--generate")) {
+            args->generator = Generator_Find(argv[++i]);
+            if (args->generator == Generator_None) {
+                fprintf(stderr, "Unknown signal: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "-i") || !strcmp(argv[i], "--input")) {
+            args->input_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--input-container") ||
+                 !strcmp(argv[i], "--output-container")) {
+            char const* label = argv[++i];
             int j;
-            for (j = 0; FORMAT_TABLE[j].label; ++j) {
-                if (!strcmp(label, FORMAT_TABLE[j].label)) {
-                    args.stream_reader = FORMAT_TABLE[j].reader;
-                    args.stream_writer = FORMAT_TABLE[j].writer;
+            for (j = 0; CONTAINER_TABLE[j].label; ++j) {
+                if (!strcmp(label, CONTAINER_TABLE[j].label)) {
+                    if (!strcmp(argv[i - 1], "--input-container")) {
+                        args->input_container = CONTAINER_TABLE[j].value;
+                    }
+                    else {
+                        args->output_container = CONTAINER_TABLE[j].value;
+                    }
                     break;
                 }
             }
-            if (!FORMAT_TABLE[j].label) {
-                fprintf(stderr, "Unknown format: %s\n", label);
+            if (!CONTAINER_TABLE[j].label) {
+                fprintf(stderr, "Unknown container: %s\n", label);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "-j") || !strcmp(argv[i], "--jobs")) {
+            args->jobs = strtol(argv[++i], NULL, 10);
+            if (args->jobs < 1) {
+                fprintf(stderr, "Invalid jobs: %s\n", argv[i]);
+                return 1;
+            }
+            else if (args->jobs > MAX_JOBS) {
+                args->jobs = MAX_JOBS;
+            }
+        }
+        else if (!strcmp(argv[i], "--latency")) {
+            args->latency = atof(argv[++i]);
+            args->throughput = 0;
+            if (args->latency <= 0) {
+                fprintf(stderr, "Invalid latency: %s\n", argv[i]);
                 return 1;
             }
         }
@@ -694,8 +968,9 @@ int main(int argc, char const* argv[])
             int j;
             for (j = 0; MODE_TABLE[j].label; ++j) {
                 if (!strcmp(label, MODE_TABLE[j].label)) {
-                    args.regs[TDA8425_RegOrder_SF] &= (TDA8425_Register)~(TDA8425_Mode_Mask << TDA8425_Reg_SF_STL);
-                    args.regs[TDA8425_RegOrder_SF] |= (TDA8425_Register)MODE_TABLE[j].value << TDA8425_Reg_SF_STL;
+                    Args_SetRegister(args, TDA8425_RegOrder_SF,
+                                     (TDA8425_Register)(TDA8425_Mode_Mask << TDA8425_Reg_SF_STL),
+                                     (TDA8425_Register)(MODE_TABLE[j].value << TDA8425_Reg_SF_STL));
                     break;
                 }
             }
@@ -704,13 +979,30 @@ int main(int argc, char const* argv[])
                 return 1;
             }
         }
+        else if (!strcmp(argv[i], "-o") || !strcmp(argv[i], "--output")) {
+            args->output_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--overlap")) {
+            args->segment_overlap = strtol(argv[++i], NULL, 10);
+            if (args->segment_overlap < 0) {
+                fprintf(stderr, "Invalid overlap: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--overlap-error")) {
+            args->segment_error = atof(argv[++i]);
+            if (args->segment_error <= 0) {
+                fprintf(stderr, "Invalid overlap error: %s\n", argv[i]);
+                return 1;
+            }
+        }
         else if (!strcmp(argv[i], "--pseudo-c1")) {
             double value = atof(argv[++i]);
             if (value <= 0) {
                 fprintf(stderr, "Invalid capacitance: %s\n", argv[i]);
                 return 1;
             }
-            args.pseudo_c1 = (TDA8425_Float)value;
+            args->pseudo_c1 = (TDA8425_Float)value;
         }
         else if (!strcmp(argv[i], "--pseudo-c2")) {
             double value = atof(argv[++i]);
@@ -718,7 +1010,7 @@ int main(int argc, char const* argv[])
                 fprintf(stderr, "Invalid capacitance: %s\n", argv[i]);
                 return 1;
             }
-            args.pseudo_c2 = (TDA8425_Float)value;
+            args->pseudo_c2 = (TDA8425_Float)value;
         }
         else if (!strcmp(argv[i], "--pseudo-preset")) {
             long preset = strtol(argv[++i], NULL, 10);
@@ -727,12 +1019,12 @@ int main(int argc, char const* argv[])
                 return 1;
             }
             --preset;
-            args.pseudo_c1 = TDA8425_Pseudo_C1_Table[preset];
-            args.pseudo_c2 = TDA8425_Pseudo_C2_Table[preset];
+            args->pseudo_c1 = TDA8425_Pseudo_C1_Table[preset];
+            args->pseudo_c2 = TDA8425_Pseudo_C2_Table[preset];
         }
         else if (!strcmp(argv[i], "-r") || !strcmp(argv[i], "--rate")) {
-            args.rate = (TDA8425_Float)atof(argv[++i]);
-            if (args.rate < 1) {
+            args->rate = (TDA8425_Float)atof(argv[++i]);
+            if (args->rate < 1) {
                 fprintf(stderr, "Invalid rate: %s\n", argv[i]);
                 return 1;
             }
@@ -754,15 +1046,27 @@ int main(int argc, char const* argv[])
                 fprintf(stderr, "Invalid register value: %s\n", argv[i]);
                 return 1;
             }
-            args.regs[r] = (TDA8425_Register)value;
+            Args_SetRegister(args, REGISTER_TABLE[r].order, 0xFF, (TDA8425_Register)value);
+        }
+        else if (!strcmp(argv[i], "--route")) {
+            if (!Args_ParseRoutes(args, argv[++i])) {
+                fprintf(stderr, "Invalid route: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--sweep")) {
+            if (!Args_ParseSweep(args, argv[++i])) {
+                fprintf(stderr, "Invalid sweep: %s\n", argv[i]);
+                return 1;
+            }
         }
         else if (!strcmp(argv[i], "-s") || !strcmp(argv[i], "--selector")) {
             char const* label = argv[++i];
             int j;
             for (j = 0; SELECTOR_TABLE[j].label; ++j) {
                 if (!strcmp(label, SELECTOR_TABLE[j].label)) {
-                    args.regs[TDA8425_RegOrder_SF] &= (TDA8425_Register)~TDA8425_Selector_Mask;
-                    args.regs[TDA8425_RegOrder_SF] |= (TDA8425_Register)SELECTOR_TABLE[j].value;
+                    Args_SetRegister(args, TDA8425_RegOrder_SF, (TDA8425_Register)TDA8425_Selector_Mask,
+                                     (TDA8425_Register)SELECTOR_TABLE[j].value);
                     break;
                 }
             }
@@ -776,7 +1080,7 @@ int main(int argc, char const* argv[])
             int j;
             for (j = 0; j < TDA8425_Tone_Data_Count; ++j) {
                 if (TDA8425_TrebleDecibel_Table[j] == db) {
-                    args.regs[TDA8425_RegOrder_TR] = (TDA8425_Register)j;
+                    Args_SetRegister(args, TDA8425_RegOrder_TR, 0xFF, (TDA8425_Register)j);
                     break;
                 }
             }
@@ -790,8 +1094,8 @@ int main(int argc, char const* argv[])
             int j;
             for (j = 0; j < TDA8425_Volume_Data_Count; ++j) {
                 if (TDA8425_VolumeDecibel_Table[j] == db) {
-                    args.regs[TDA8425_RegOrder_VL] = (TDA8425_Register)j;
-                    args.regs[TDA8425_RegOrder_VR] = (TDA8425_Register)j;
+                    Args_SetRegister(args, TDA8425_RegOrder_VL, 0xFF, (TDA8425_Register)j);
+                    Args_SetRegister(args, TDA8425_RegOrder_VR, 0xFF, (TDA8425_Register)j);
                     break;
                 }
             }
@@ -805,7 +1109,7 @@ int main(int argc, char const* argv[])
             int j;
             for (j = 0; j < TDA8425_Volume_Data_Count; ++j) {
                 if (TDA8425_VolumeDecibel_Table[j] == db) {
-                    args.regs[TDA8425_RegOrder_VL] = (TDA8425_Register)j;
+                    Args_SetRegister(args, TDA8425_RegOrder_VL, 0xFF, (TDA8425_Register)j);
                     break;
                 }
             }
@@ -819,7 +1123,7 @@ int main(int argc, char const* argv[])
             int j;
             for (j = 0; j < TDA8425_Volume_Data_Count; ++j) {
                 if (TDA8425_VolumeDecibel_Table[j] == db) {
-                    args.regs[TDA8425_RegOrder_VR] = (TDA8425_Register)j;
+                    Args_SetRegister(args, TDA8425_RegOrder_VR, 0xFF, (TDA8425_Register)j);
                     break;
                 }
             }
@@ -840,74 +1144,2593 @@ int main(int argc, char const* argv[])
         }
     }
 
-#ifdef __WINDOWS__
-    _setmode(_fileno(stdin), O_BINARY);
-    if (errno) {
-        perror("_setmode(stdin)");
-        return 1;
+    return -1;
+}
+
+
+// Persistent worker threads, running TDA8425_ForEach tasks along with the
+// calling thread, which claim indices one at a time
+typedef struct WorkerPool {
+    Thread threads[MAX_JOBS];
+    long thread_count;
+    Mutex mutex;
+    Condition wake;       // new batch, or quitting
+    Condition done;       // all the workers left the batch
+    unsigned long batch;  // batch sequence number
+    long busy;            // workers still within the batch
+    int quit;
+
+    TDA8425_Task task;
+    void* arg;
+    TDA8425_Index count;
+    unsigned long volatile next;  // next index to claim
+} WorkerPool;
+
+
+static void WorkerPool_Drain(WorkerPool* self)
+{
+    for (;;) {
+        TDA8425_Index index = (TDA8425_Index)Atomic_FetchAdd(&self->next, 1);
+        if (index >= self->count) {
+            break;
+        }
+        self->task(self->arg, index);
     }
+}
 
-    _setmode(_fileno(stdout), O_BINARY);
-    if (errno) {
-        perror("_setmode(stdout)");
-        return 1;
+
+static THREAD_ROUTINE(WorkerPool_Routine, arg)
+{
+    WorkerPool* self = (WorkerPool*)arg;
+    unsigned long batch = 0;
+
+    Mutex_Lock(&self->mutex);
+    for (;;) {
+        while (self->batch == batch && !self->quit) {
+            Condition_Wait(&self->wake, &self->mutex);
+        }
+        if (self->quit) {
+            break;
+        }
+        batch = self->batch;
+        Mutex_Unlock(&self->mutex);
+
+        WorkerPool_Drain(self);
+
+        Mutex_Lock(&self->mutex);
+        if (!--self->busy) {
+            Condition_Signal(&self->done);
+        }
     }
-#endif  // __WINDOWS__
+    Mutex_Unlock(&self->mutex);
+    THREAD_RETURN;
+}
 
-    return Run(&args);
+
+// Starts up to jobs - 1 threads; any not started leave their work to the
+// calling thread
+static void WorkerPool_Start(WorkerPool* self, long jobs)
+{
+    Mutex_Init(&self->mutex);
+    Condition_Init(&self->wake);
+    Condition_Init(&self->done);
+    self->batch = 0;
+    self->busy = 0;
+    self->quit = 0;
+
+    for (self->thread_count = 0; self->thread_count < jobs - 1; ++self->thread_count) {
+        if (!Thread_Start(&self->threads[self->thread_count], WorkerPool_Routine, self)) {
+            break;
+        }
+    }
+}
+
+
+static void WorkerPool_Stop(WorkerPool* self)
+{
+    Mutex_Lock(&self->mutex);
+    self->quit = 1;
+    Condition_Broadcast(&self->wake);
+    Mutex_Unlock(&self->mutex);
+
+    for (long t = 0; t < self->thread_count; ++t) {
+        Thread_Join(&self->threads[t]);
+    }
+    self->thread_count = 0;
+
+    Condition_Destroy(&self->done);
+    Condition_Destroy(&self->wake);
+    Mutex_Destroy(&self->mutex);
+}
+
+
+// TDA8425_ForEach over a started WorkerPool
+static void WorkerPool_ForEach(void* context, TDA8425_Task task, void* arg, TDA8425_Index count)
+{
+    WorkerPool* self = (WorkerPool*)context;
+
+    if (!self->thread_count || count <= 1) {
+        for (TDA8425_Index index = 0; index < count; ++index) {
+            task(arg, index);
+        }
+        return;
+    }
+
+    Mutex_Lock(&self->mutex);
+    self->task = task;
+    self->arg = arg;
+    self->count = count;
+    self->next = 0;
+    self->busy = self->thread_count;
+    ++self->batch;
+    Condition_Broadcast(&self->wake);
+    Mutex_Unlock(&self->mutex);
+
+    WorkerPool_Drain(self);
+
+    Mutex_Lock(&self->mutex);
+    while (self->busy) {
+        Condition_Wait(&self->done, &self->mutex);
+    }
+    Mutex_Unlock(&self->mutex);
+}
+
+
+// Reads until the buffer is full or the stream ends; returns the bytes read,
+// or -1 on errors.
+static long ReadFully(int fd, void* buffer, long size)
+{
+    uint8_t* ptr = (uint8_t*)buffer;
+    long done = 0;
+
+    while (done < size) {
+        long result = (long)READ_FD(fd, &ptr[done], (size_t)(size - done));
+        if (result < 0) {
+            if (errno == EINTR) {
+                errno = 0;
+                continue;
+            }
+            return -1;
+        }
+        if (!result) {
+            break;  // end of stream
+        }
+        done += result;
+    }
+    return done;
+}
+
+
+// Writes the whole buffer; returns 0 on errors.
+static int WriteFully(int fd, void const* buffer, long size)
+{
+    uint8_t const* ptr = (uint8_t const*)buffer;
+    long done = 0;
+
+    while (done < size) {
+        long result = (long)WRITE_FD(fd, &ptr[done], (size_t)(size - done));
+        if (result < 0) {
+            if (errno == EINTR) {
+                errno = 0;
+                continue;
+            }
+            return 0;
+        }
+        done += result;
+    }
+    return 1;
 }
 
 
-static int Run(Args const* args)
+// Frames are stored chip by chip, each with the given stride
+static void ScatterInputs(Args const* args, TDA8425_Float const* samples,
+                          TDA8425_Chip_Process_Data* frames, TDA8425_Index stride, TDA8425_Index count)
 {
-    TDA8425_Chip* chip;
-    chip = (TDA8425_Chip*)malloc(sizeof(TDA8425_Chip));
-    if (!chip) {
+    for (long chip = 0; chip < args->chips; ++chip) {
+        long const* routes = args->routes[chip];
+        TDA8425_Chip_Process_Data* chip_frames = &frames[(TDA8425_Index)chip * stride];
+
+        for (TDA8425_Index index = 0; index < count; ++index) {
+            TDA8425_Float const* frame_samples = &samples[index * (TDA8425_Index)args->channels];
+            TDA8425_Float* inputs = &chip_frames[index].inputs[0][0];  // overflows
+
+            for (long input = 0; input < MAX_INPUTS; ++input) {
+                inputs[input] = (routes[input] >= 0 ? frame_samples[routes[input]] : 0);
+            }
+        }
+    }
+}
+
+
+static void GatherOutputs(Args const* args, TDA8425_Chip_Process_Data const* frames,
+                          TDA8425_Index stride, TDA8425_Index count, TDA8425_Float* samples)
+{
+    for (TDA8425_Index index = 0; index < count; ++index) {
+        for (long chip = 0; chip < args->chips; ++chip) {
+            TDA8425_Chip_Process_Data const* frame = &frames[(TDA8425_Index)chip * stride + index];
+
+            for (long channel = 0; channel < MAX_OUTPUTS; ++channel) {
+                *samples++ = frame->outputs[channel];
+            }
+        }
+    }
+}
+
+
+// Input stream: a memory-mapped file, or a stream (standard input, a pipe, or
+// a device), optionally within the data chunk of a WAV container; else a
+// generated signal.
+typedef struct Input {
+    int fd;
+    FileMap map;
+    int mapped;
+    int streamed;                    // fd opened from a non-regular file
+    int wave;
+    int generated;
+    Generator generator;
+    uint8_t const* data;             // mapped data chunk
+    size_t offset;                   // mapped header bytes read
+    uint64_t size;                   // data bytes left, or WAVE_UNKNOWN_SIZE
+    uint8_t prefix[WAVE_PEEK_SIZE];  // peeked bytes of a raw stream
+    long prefix_size;
+    long prefix_offset;
+} Input;
+
+
+// Wave_Reader of header bytes
+static long Input_ReadHeader(void* context, void* buffer, long size)
+{
+    Input* self = (Input*)context;
+
+    if (self->mapped) {
+        size_t available = self->map.size - self->offset;
+        if ((size_t)size > available) {
+            size = (long)available;
+        }
+        if (size) {
+            memcpy(buffer, (uint8_t const*)self->map.data + self->offset, (size_t)size);
+            self->offset += (size_t)size;
+        }
+        return size;
+    }
+    return ReadFully(self->fd, buffer, size);
+}
+
+
+// Reads streamed data bytes, like ReadFully()
+static long Input_Read(Input* self, void* buffer, long size)
+{
+    uint8_t* ptr = (uint8_t*)buffer;
+    long done = 0;
+
+    if ((uint64_t)size > self->size) {
+        size = (long)self->size;
+    }
+    while (done < size && self->prefix_offset < self->prefix_size) {
+        ptr[done++] = self->prefix[self->prefix_offset++];
+    }
+    long result = ReadFully(self->fd, &ptr[done], size - done);
+    if (result < 0) {
+        return -1;
+    }
+    done += result;
+    if (self->size != WAVE_UNKNOWN_SIZE) {
+        self->size -= (uint64_t)done;
+    }
+    return done;
+}
+
+
+static void Input_Close(Input* self)
+{
+    if (self->mapped) {
+        FileMap_Close(&self->map);
+        self->mapped = 0;
+    }
+    if (self->streamed) {
+        CLOSE_FD(self->fd);
+        self->streamed = 0;
+    }
+}
+
+
+// Opens the input, and applies the format of its WAV header, if any
+static int Input_Open(Input* self, Args* args)
+{
+    memset(self, 0, sizeof(*self));
+    self->fd = fileno(stdin);
+    self->size = WAVE_UNKNOWN_SIZE;
+
+    if (args->generator != Generator_None) {
+        uint64_t frames = (uint64_t)(args->duration * (double)args->rate + 0.5);
+        Generator_Init(&self->generator, args->generator, args->channels, (double)args->rate, frames);
+        self->generated = 1;
+        self->size = frames * (uint64_t)args->channels * (uint64_t)args->format->size;
         return 1;
     }
-    TDA8425_Chip_Ctor(chip);
-    TDA8425_Chip_Setup(chip, args->rate, args->pseudo_c1, args->pseudo_c2, args->tfilter_mode);
-    TDA8425_Chip_Reset(chip);
-    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_VL, args->regs[TDA8425_RegOrder_VL]);
-    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_VR, args->regs[TDA8425_RegOrder_VR]);
-    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_BA, args->regs[TDA8425_RegOrder_BA]);
-    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_TR, args->regs[TDA8425_RegOrder_TR]);
-    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_SF, args->regs[TDA8425_RegOrder_SF]);
-    TDA8425_Chip_Start(chip);
-    int error = 0;
 
-    while (!feof(stdin)) {
-        TDA8425_Chip_Process_Data data;
-        long channel;
+    if (args->input_path) {
+        int opened = FileMap_OpenRead(&self->map, args->input_path);
+        if (!opened) {
+            perror(args->input_path);
+            return 0;
+        }
+        if (opened > 0) {
+            self->mapped = 1;
+        }
+        else {
+            // Not mappable, so read as a stream, like standard input
+            self->fd = FileMap_DetachStream(&self->map);
+            if (self->fd < 0) {
+                perror(args->input_path);
+                return 0;
+            }
+            self->streamed = 1;
+        }
+    }
+
+    if (args->input_container != Container_Raw) {
+        uint8_t peek[WAVE_PEEK_SIZE];
+        long peeked = Input_ReadHeader(self, peek, (long)sizeof(peek));
+        if (peeked < 0) {
+            perror("read()");
+            Input_Close(self);
+            return 0;
+        }
 
-        TDA8425_Float* inputs = &data.inputs[0][0];  // overflows
-        for (channel = 0; channel < args->channels; ++channel) {
-            if (!args->stream_reader(&inputs[channel])) {
-                if (ferror(stdin)) {
-                    perror("stream_reader()");
-                    error = 1;
-                }
-                goto end;
+        if (Wave_Detect(peek, (size_t)peeked)) {
+            WaveInfo info;
+            char const* message = Wave_ReadHeader(&info, peek, Input_ReadHeader, self);
+            if (!message && info.channels > MAX_CHANNELS) {
+                message = "Unsupported WAV channels";
+            }
+            if (message) {
+                fprintf(stderr, "%s\n", message);
+                Input_Close(self);
+                return 0;
+            }
+            args->format = info.format;
+            args->channels = info.channels;
+            args->rate = (TDA8425_Float)info.rate;
+            self->wave = 1;
+            self->size = info.data_size;
+        }
+        else if (args->input_container == Container_Wave) {
+            fprintf(stderr, "Not a WAV input\n");
+            Input_Close(self);
+            return 0;
+        }
+        else if (self->mapped) {
+            self->offset = 0;
+        }
+        else {
+            memcpy(self->prefix, peek, (size_t)peeked);
+            self->prefix_size = peeked;
+        }
+    }
+
+    if (self->mapped) {
+        size_t available = self->map.size - self->offset;
+        if (self->size > (uint64_t)available) {
+            self->size = (uint64_t)available;
+        }
+        self->data = (uint8_t const*)self->map.data + self->offset;
+    }
+    return 1;
+}
+
+
+// Output stream: a memory-mapped file sized in advance, or standard output,
+// optionally within the data chunk of a WAV container; else discarded.
+typedef struct Output {
+    int fd;
+    FileMap map;
+    int mapped;
+    int wave;
+    int null;
+    uint8_t* data;  // mapped data chunk
+    WaveInfo info;
+} Output;
+
+
+// Opens the output, with a header for the given data size, or for a stream if
+// unknown; only outputs of known size are memory-mapped.
+static int Output_Open(Output* self, Args const* args, Input const* input, uint64_t data_size)
+{
+    uint8_t header[WAVE_MAX_HEADER_SIZE];
+    size_t header_size = 0;
+
+    memset(self, 0, sizeof(*self));
+    self->fd = fileno(stdout);
+    if (args->null_output) {
+        self->null = 1;
+        return 1;
+    }
+    self->wave = (args->output_container == Container_Auto ? input->wave :
+                  args->output_container == Container_Wave);
+    self->info.format = args->format;
+    self->info.channels = args->chips * MAX_OUTPUTS;
+    self->info.rate = (unsigned long)(args->rate + (TDA8425_Float)0.5);
+    self->info.data_size = data_size;
+
+    if (self->wave) {
+        header_size = Wave_FormatHeader(header, &self->info);
+        if (!header_size) {
+            fprintf(stderr, "Unsupported WAV format: %s\n", args->format->label);
+            return 0;
+        }
+    }
+
+    if (args->output_path) {
+        if (data_size != WAVE_UNKNOWN_SIZE) {
+            if (!FileMap_CreateWrite(&self->map, args->output_path, header_size + (size_t)data_size)) {
+                perror(args->output_path);
+                return 0;
+            }
+            self->mapped = 1;
+            self->data = (uint8_t*)self->map.data + header_size;
+            if (header_size) {
+                memcpy(self->map.data, header, header_size);
             }
+            return 1;
         }
-        for (; channel < MAX_INPUTS; ++channel) {
-            inputs[channel] = 0;
+        if (!freopen(args->output_path, "wb", stdout)) {
+            perror(args->output_path);
+            return 0;
         }
+        self->fd = fileno(stdout);
+    }
+
+    if (header_size && !WriteFully(self->fd, header, (long)header_size)) {
+        perror("write()");
+        return 0;
+    }
+    return 1;
+}
 
-        TDA8425_Chip_Process(chip, &data);
 
-        for (channel = 0; channel < MAX_OUTPUTS; ++channel) {
-            if (!args->stream_writer(data.outputs[channel])) {
-                perror("stream_writer()");
+// Closes the output, back-patching the header with the final data size, if
+// seekable
+static int Output_Close(Output* self, uint64_t data_size)
+{
+    int error = 0;
+
+    if (self->mapped) {
+        FileMap_Close(&self->map);
+        self->mapped = 0;
+    }
+    else if (self->wave && self->info.data_size != data_size) {
+        if (SEEK_FD(self->fd, 0, SEEK_SET) == 0) {
+            uint8_t header[WAVE_MAX_HEADER_SIZE];
+            self->info.data_size = data_size;
+            size_t header_size = Wave_FormatHeader(header, &self->info);
+            if (!WriteFully(self->fd, header, (long)header_size) ||
+                SEEK_FD(self->fd, 0, SEEK_END) < 0) {
+                perror("write()");
                 error = 1;
-                goto end;
             }
         }
+        errno = 0;  // not seekable, left as a stream
     }
-
-end:
-    TDA8425_Chip_Stop(chip);
-    TDA8425_Chip_Dtor(chip);
-    free(chip);
     return error;
 }
+
+
+// Pipeline of blocks: the reader decodes a block into a free slot, the DSP
+// processes it in place, and the writer encodes and writes it, then frees
+// the slot. Each stage owns its own cursor, so the slot ring is lock-free.
+typedef struct Slot {
+    TDA8425_Chip_Process_Data* frames;  // block_frames per chip
+    TDA8425_Index count;
+    int last;  // end of stream or error
+} Slot;
+
+
+#define MAX_SLOTS 16
+
+typedef struct Pipeline {
+    Args const* args;
+    TDA8425_Chip* chips;
+    TDA8425_Recorder* recorders;  // per chip, for --record
+    TDA8425_WriteRecord* records;
+    size_t record_capacity;       // per chip
+    TDA8425_Meter* meters;        // per chip, for --stats
+    WorkerPool pool;              // for --jobs
+    long input_frame_size;
+    long output_frame_size;
+    long block_frames;
+    long slot_count;
+    Slot slots[MAX_SLOTS];
+
+    unsigned long volatile read_cursor;     // slots filled by the reader
+    unsigned long volatile process_cursor;  // slots processed by the DSP
+    unsigned long volatile write_cursor;    // slots released by the writer
+    unsigned long volatile error;
+    double read_time;     // busy time of each stage [s]
+    double process_time;
+    double write_time;
+
+    // DSP
+    EventList const* events;
+    size_t next_event;
+    uint64_t process_frame;
+
+    // Reader
+    Input* input;
+    size_t input_offset;
+    void* input_buffer;
+    TDA8425_Float* input_samples;
+    long trailing;
+
+    // Writer
+    Output* output;
+    size_t output_offset;
+    void* output_buffer;
+    TDA8425_Float* output_samples;
+    long long total_frames;
+} Pipeline;
+
+
+// Decodes the bytes read into a slot; fewer than a whole block end the stream
+static void Pipeline_Decode(Pipeline* self, Slot* slot, void const* input_data, long size)
+{
+    Args const* args = self->args;
+    long capacity = self->block_frames * self->input_frame_size;
+
+    slot->count = (TDA8425_Index)(size / self->input_frame_size);
+    slot->last = (size < capacity);
+    self->trailing = size % self->input_frame_size;  // only at the end of stream
+
+    args->format->decoder(self->input_samples, input_data, (size_t)slot->count * (size_t)args->channels);
+    ScatterInputs(args, self->input_samples, slot->frames, (TDA8425_Index)self->block_frames, slot->count);
+}
+
+
+static void Pipeline_Read(Pipeline* self, Slot* slot)
+{
+    Args const* args = self->args;
+    long capacity = self->block_frames * self->input_frame_size;
+    void const* input_data = self->input_buffer;
+    long size;
+
+    slot->count = 0;
+    slot->last = 1;
+    if (Atomic_Load(&self->error)) {
+        return;
+    }
+
+    if (self->input->generated) {
+        slot->count = (TDA8425_Index)Generator_Render(&self->input->generator, self->input_samples,
+                                                      (size_t)self->block_frames);
+        slot->last = (slot->count < (TDA8425_Index)self->block_frames);
+        ScatterInputs(args, self->input_samples, slot->frames, (TDA8425_Index)self->block_frames, slot->count);
+        return;
+    }
+    else if (self->input->mapped) {
+        size_t remaining = (size_t)self->input->size - self->input_offset;
+        size = capacity;
+        if (remaining < (size_t)size) {
+            size = (long)remaining;
+        }
+        if (size) {
+            input_data = self->input->data + self->input_offset;
+            self->input_offset += (size_t)size;
+        }
+    }
+    else {
+        size = Input_Read(self->input, self->input_buffer, capacity);
+        if (size < 0) {
+            perror("read()");
+            Atomic_Store(&self->error, 1);
+            return;
+        }
+    }
+    Pipeline_Decode(self, slot, input_data, size);
+}
+
+
+typedef struct PipelineSpan {
+    Pipeline* self;
+    Slot* slot;
+    TDA8425_Index first;
+    TDA8425_Index count;
+} PipelineSpan;
+
+
+static void Pipeline_ChipTask(void* arg, TDA8425_Index index)
+{
+    PipelineSpan const* span = (PipelineSpan const*)arg;
+    TDA8425_Index offset = index * (TDA8425_Index)span->self->block_frames + span->first;
+
+    TDA8425_Chip_ProcessBlock(&span->self->chips[index], &span->slot->frames[offset], span->count);
+}
+
+
+static void Pipeline_ProcessSpan(Pipeline* self, Slot* slot, TDA8425_Index first, TDA8425_Index count)
+{
+    Args const* args = self->args;
+    int parallel = (args->jobs > 1 && count >= (TDA8425_Index)MIN_PARALLEL_FRAMES);
+
+    if (args->chips > 1) {
+        // Independent chips in parallel
+        PipelineSpan span;
+        span.self = self;
+        span.slot = slot;
+        span.first = first;
+        span.count = count;
+        if (parallel) {
+            WorkerPool_ForEach(&self->pool, Pipeline_ChipTask, &span, (TDA8425_Index)args->chips);
+        }
+        else {
+            for (long c = 0; c < args->chips; ++c) {
+                Pipeline_ChipTask(&span, (TDA8425_Index)c);
+            }
+        }
+    }
+    else if (parallel) {
+        if (!TDA8425_Chip_ProcessChunked(self->chips, &slot->frames[first], count, (TDA8425_Index)args->jobs,
+                                         WorkerPool_ForEach, &self->pool)) {
+            perror("TDA8425_Chip_ProcessChunked()");
+            Atomic_Store(&self->error, 1);
+        }
+    }
+    else {
+        TDA8425_Chip_ProcessBlock(self->chips, &slot->frames[first], count);
+    }
+}
+
+
+// Splits the block at the frames of register write events, so that whole
+// spans between them are processed in bulk.
+static void Pipeline_Process(Pipeline* self, Slot* slot)
+{
+    EventList const* events = self->events;
+    uint64_t first = self->process_frame;
+    TDA8425_Index done = 0;
+
+    if (Atomic_Load(&self->error)) {
+        return;
+    }
+    while (done < slot->count) {
+        TDA8425_Index end = slot->count;
+
+        for (; self->next_event < events->count; ++self->next_event) {
+            Event const* event = &events->events[self->next_event];
+            if (event->frame > first + done) {
+                if (event->frame < first + slot->count) {
+                    end = (TDA8425_Index)(event->frame - first);
+                }
+                break;
+            }
+            TDA8425_Chip_Write(&self->chips[event->address >> 4], event->address & 0x0F, event->data);
+        }
+        Pipeline_ProcessSpan(self, slot, done, end - done);
+        done = end;
+    }
+    self->process_frame += (uint64_t)slot->count;
+}
+
+
+// Encodes the processed frames of a slot
+static void Pipeline_Encode(Pipeline* self, Slot const* slot, void* output_data)
+{
+    Args const* args = self->args;
+
+    GatherOutputs(args, slot->frames, (TDA8425_Index)self->block_frames, slot->count, self->output_samples);
+    args->format->encoder(output_data, self->output_samples,
+                          (size_t)slot->count * (size_t)(args->chips * MAX_OUTPUTS));
+}
+
+
+static void Pipeline_Write(Pipeline* self, Slot* slot)
+{
+    void* output_data = self->output_buffer;
+
+    if (Atomic_Load(&self->error) || !slot->count) {
+        return;
+    }
+    if (self->output->mapped) {
+        output_data = self->output->data + self->output_offset;
+        self->output_offset += (size_t)slot->count * (size_t)self->output_frame_size;
+    }
+    Pipeline_Encode(self, slot, output_data);
+
+    if (!self->output->mapped && !self->output->null &&
+        !WriteFully(self->output->fd, self->output_buffer, (long)slot->count * self->output_frame_size)) {
+        perror("write()");
+        Atomic_Store(&self->error, 1);
+        return;
+    }
+    self->total_frames += (long long)slot->count;
+}
+
+
+// Waits until the cursor differs from the given value, sleeping after a while
+static void Pipeline_Wait(unsigned long volatile* cursor, unsigned long value, unsigned long distance)
+{
+    unsigned spins = 0;
+
+    while (Atomic_Load(cursor) - value + distance == 0) {
+        if (++spins < 64) {
+            Thread_Yield();
+        }
+        else {
+            Thread_Sleep(100);
+        }
+    }
+}
+
+
+static THREAD_ROUTINE(Pipeline_ReaderRoutine, arg)
+{
+    Pipeline* self = (Pipeline*)arg;
+
+    for (unsigned long seq = 0; ; ++seq) {
+        Slot* slot = &self->slots[seq % (unsigned long)self->slot_count];
+        Pipeline_Wait(&self->write_cursor, seq, (unsigned long)self->slot_count);  // wait for a free slot
+        double start_time = Clock_Seconds();
+        Pipeline_Read(self, slot);
+        self->read_time += Clock_Seconds() - start_time;
+        Atomic_Store(&self->read_cursor, seq + 1);
+        if (slot->last) {
+            break;
+        }
+    }
+    THREAD_RETURN;
+}
+
+
+static THREAD_ROUTINE(Pipeline_WriterRoutine, arg)
+{
+    Pipeline* self = (Pipeline*)arg;
+
+    for (unsigned long seq = 0; ; ++seq) {
+        Slot* slot = &self->slots[seq % (unsigned long)self->slot_count];
+        Pipeline_Wait(&self->process_cursor, seq, 0);  // wait for a processed slot
+        double start_time = Clock_Seconds();
+        Pipeline_Write(self, slot);
+        self->write_time += Clock_Seconds() - start_time;
+        Atomic_Store(&self->write_cursor, seq + 1);
+        if (slot->last) {
+            break;
+        }
+    }
+    THREAD_RETURN;
+}
+
+
+static void Pipeline_RunThreaded(Pipeline* self, int writing)
+{
+    // The DSP stage runs on the calling thread, also as writer fallback
+    for (unsigned long seq = 0; ; ++seq) {
+        Slot* slot = &self->slots[seq % (unsigned long)self->slot_count];
+        Pipeline_Wait(&self->read_cursor, seq, 0);  // wait for a filled slot
+        double start_time = Clock_Seconds();
+        Pipeline_Process(self, slot);
+        self->process_time += Clock_Seconds() - start_time;
+        Atomic_Store(&self->process_cursor, seq + 1);
+        if (writing) {
+            start_time = Clock_Seconds();
+            Pipeline_Write(self, slot);
+            self->write_time += Clock_Seconds() - start_time;
+            Atomic_Store(&self->write_cursor, seq + 1);
+        }
+        if (slot->last) {
+            break;
+        }
+    }
+}
+
+
+static void Pipeline_RunSerial(Pipeline* self)
+{
+    Slot* slot = &self->slots[0];
+
+    do {
+        double start_time = Clock_Seconds();
+        Pipeline_Read(self, slot);
+        double read_time = Clock_Seconds();
+        Pipeline_Process(self, slot);
+        double process_time = Clock_Seconds();
+        Pipeline_Write(self, slot);
+        double write_time = Clock_Seconds();
+
+        self->read_time += read_time - start_time;
+        self->process_time += process_time - read_time;
+        self->write_time += write_time - process_time;
+    } while (!slot->last);
+}
+
+
+// io_uring backend: the reads and writes of the streams are queued for all
+// the slots in flight, into registered buffers, while the DSP runs on the
+// calling thread, without reader and writer threads. Regular files are
+// accessed at explicit offsets, with many requests in flight; pipes keep at
+// most one request in flight per direction, to preserve their order.
+enum {
+    URING_READ  = 0,
+    URING_WRITE = 1
+};
+
+typedef struct UringStream {
+    int fd;
+    int enabled;      // queued via io_uring, else synchronous
+    int seekable;     // explicit offsets
+    uint64_t offset;  // next file offset, if seekable
+    int busy;         // pipe request in flight
+} UringStream;
+
+typedef struct UringSlot {
+    uint8_t* data[2];    // registered input and output buffers
+    unsigned size[2];    // bytes to transfer
+    unsigned done[2];    // bytes transferred
+    uint64_t offset[2];  // file offsets, if seekable
+    int ready[2];        // read filled, or write completed
+} UringSlot;
+
+typedef struct PipelineUring {
+    Uring uring;
+    UringStream streams[2];
+    UringSlot slots[MAX_SLOTS];
+    unsigned inflight;
+    int error;
+} PipelineUring;
+
+
+static void UringStream_Init(UringStream* self, int fd, int enabled)
+{
+    memset(self, 0, sizeof(*self));
+    self->fd = fd;
+    self->enabled = enabled;
+#if URING_SUPPORTED
+    // Appending ignores offsets, so appended files are streamed
+    struct stat info;
+    if (enabled && !fstat(fd, &info) && S_ISREG(info.st_mode) && !(fcntl(fd, F_GETFL) & O_APPEND)) {
+        off_t offset = lseek(fd, 0, SEEK_CUR);
+        if (offset >= 0) {
+            self->seekable = 1;
+            self->offset = (uint64_t)offset;
+        }
+    }
+    errno = 0;
+#endif
+}
+
+
+// Queues the rest of a slot transfer
+static void PipelineUring_Queue(PipelineUring* self, unsigned index, int kind)
+{
+    UringStream* stream = &self->streams[kind];
+    UringSlot* slot = &self->slots[index];
+    uint64_t offset = (stream->seekable ? slot->offset[kind] + slot->done[kind] : URING_STREAM_OFFSET);
+    uint8_t* data = slot->data[kind] + slot->done[kind];
+    unsigned size = slot->size[kind] - slot->done[kind];
+    uint64_t user_data = ((uint64_t)index << 1) | (uint64_t)kind;
+    unsigned buffer_index = index * 2 + (unsigned)kind;
+    int queued;
+
+    if (kind == URING_READ) {
+        queued = Uring_QueueRead(&self->uring, stream->fd, data, size, offset, buffer_index, user_data);
+    }
+    else {
+        queued = Uring_QueueWrite(&self->uring, stream->fd, data, size, offset, buffer_index, user_data);
+    }
+    if (queued) {
+        stream->busy = 1;
+        ++self->inflight;
+    }
+    else {
+        fprintf(stderr, "io_uring submission queue full\n");
+        self->error = 1;
+    }
+}
+
+
+// Handles the completions, queueing the rest of short transfers
+static void PipelineUring_Reap(PipelineUring* self)
+{
+    uint64_t user_data;
+    int result;
+
+    while (Uring_Reap(&self->uring, &user_data, &result)) {
+        unsigned index = (unsigned)(user_data >> 1);
+        int kind = (int)(user_data & 1);
+        UringSlot* slot = &self->slots[index];
+
+        --self->inflight;
+        self->streams[kind].busy = 0;
+        if (result < 0 || (!result && kind == URING_WRITE)) {
+            if (!self->error) {
+                errno = (result < 0 ? -result : EIO);
+                perror(kind == URING_READ ? "io_uring read()" : "io_uring write()");
+            }
+            self->error = 1;
+            continue;
+        }
+
+        slot->done[kind] += (unsigned)result;
+        if (slot->done[kind] < slot->size[kind] && result && !self->error) {
+            PipelineUring_Queue(self, index, kind);
+        }
+        else {
+            slot->ready[kind] = 1;  // filled, or end of stream
+        }
+    }
+}
+
+
+// Runs the pipeline via io_uring; returns 0 if not available, before any I/O,
+// with the reason
+static int Pipeline_RunUring(Pipeline* self, char const** reason)
+{
+    Input* input = self->input;
+    unsigned long slot_count = (unsigned long)self->slot_count;
+    size_t input_capacity = (size_t)(self->block_frames * self->input_frame_size);
+    size_t output_capacity = (size_t)(self->block_frames * self->output_frame_size);
+    UringBuffer buffers[MAX_SLOTS * 2];
+    int available = 0;
+
+    PipelineUring* ctx = (PipelineUring*)calloc(1, sizeof(PipelineUring));
+    if (!ctx) {
+        *reason = strerror(ENOMEM);
+        return 0;
+    }
+    UringStream* reader = &ctx->streams[URING_READ];
+    UringStream* writer = &ctx->streams[URING_WRITE];
+    UringStream_Init(reader, input->fd, !input->mapped && !input->generated);
+    UringStream_Init(writer, self->output->fd, !self->output->mapped && !self->output->null);
+    if (!reader->enabled && !writer->enabled) {
+        *reason = "no streams";
+        goto end;
+    }
+
+    // Both buffers of every slot are registered, even if synchronous
+    for (unsigned long s = 0; s < slot_count; ++s) {
+        UringSlot* slot = &ctx->slots[s];
+        slot->data[URING_READ] = (uint8_t*)malloc(input_capacity);
+        slot->data[URING_WRITE] = (uint8_t*)malloc(output_capacity);
+        if (!slot->data[URING_READ] || !slot->data[URING_WRITE]) {
+            *reason = strerror(ENOMEM);
+            goto end;
+        }
+        buffers[s * 2 + URING_READ].data = slot->data[URING_READ];
+        buffers[s * 2 + URING_READ].size = input_capacity;
+        buffers[s * 2 + URING_WRITE].data = slot->data[URING_WRITE];
+        buffers[s * 2 + URING_WRITE].size = output_capacity;
+    }
+    if (!Uring_Init(&ctx->uring, (unsigned)(slot_count * 2))) {
+        *reason = strerror(errno);
+        goto end;
+    }
+    if (!Uring_RegisterBuffers(&ctx->uring, buffers, (unsigned)(slot_count * 2))) {
+        *reason = strerror(errno);
+        Uring_Exit(&ctx->uring);
+        goto end;
+    }
+    available = 1;
+    errno = 0;
+
+    unsigned long read_seq = 0;     // next slot to read
+    unsigned long process_seq = 0;  // next slot to process
+    unsigned long write_seq = 0;    // next slot to write
+    unsigned long release_seq = 0;  // next slot to be written completely
+    int reading = 1;
+    int finished = 0;
+
+    for (;;) {
+        int progress = 0;
+        ctx->error |= (int)Atomic_Load(&self->error);
+
+        // Reads into free slots
+        while (!ctx->error && reading && read_seq - release_seq < slot_count &&
+               (!reader->busy || reader->seekable)) {
+            unsigned index = (unsigned)(read_seq % slot_count);
+            UringSlot* slot = &ctx->slots[index];
+            slot->done[URING_READ] = 0;
+            slot->ready[URING_READ] = 0;
+            slot->ready[URING_WRITE] = 0;
+            progress = 1;
+            ++read_seq;
+
+            if (!reader->enabled) {
+                double start_time = Clock_Seconds();
+                Pipeline_Read(self, &self->slots[index]);
+                self->read_time += Clock_Seconds() - start_time;
+                slot->ready[URING_READ] = 1;
+                reading = !self->slots[index].last;
+                continue;
+            }
+
+            // Peeked bytes first, then up to the data size, if known
+            uint64_t size = input_capacity;
+            if (size > input->size) {
+                size = input->size;
+            }
+            while (slot->done[URING_READ] < size && input->prefix_offset < input->prefix_size) {
+                slot->data[URING_READ][slot->done[URING_READ]++] = input->prefix[input->prefix_offset++];
+            }
+            if (input->size != WAVE_UNKNOWN_SIZE) {
+                input->size -= size;
+            }
+            slot->size[URING_READ] = (unsigned)size;
+            slot->offset[URING_READ] = reader->offset - slot->done[URING_READ];
+            if (reader->seekable) {
+                reader->offset += size - slot->done[URING_READ];
+            }
+            if (slot->done[URING_READ] < slot->size[URING_READ]) {
+                PipelineUring_Queue(ctx, index, URING_READ);
+            }
+            else {
+                slot->ready[URING_READ] = 1;
+            }
+        }
+
+        // DSP on the next filled slot
+        if (!ctx->error && !finished && process_seq < read_seq &&
+            ctx->slots[process_seq % slot_count].ready[URING_READ]) {
+            unsigned index = (unsigned)(process_seq % slot_count);
+            Slot* slot = &self->slots[index];
+            double start_time = Clock_Seconds();
+            if (reader->enabled) {
+                Pipeline_Decode(self, slot, ctx->slots[index].data[URING_READ],
+                                (long)ctx->slots[index].done[URING_READ]);
+            }
+            double process_time = Clock_Seconds();
+            Pipeline_Process(self, slot);
+            self->read_time += process_time - start_time;
+            self->process_time += Clock_Seconds() - process_time;
+            finished = slot->last;
+            reading &= !finished;
+            progress = 1;
+            ++process_seq;
+        }
+
+        // Writes of the processed slots, in order
+        while (!ctx->error && write_seq < process_seq && (!writer->busy || writer->seekable)) {
+            unsigned index = (unsigned)(write_seq % slot_count);
+            UringSlot* uslot = &ctx->slots[index];
+            Slot* slot = &self->slots[index];
+            double start_time = Clock_Seconds();
+            progress = 1;
+            ++write_seq;
+
+            if (!writer->enabled) {
+                Pipeline_Write(self, slot);
+                uslot->ready[URING_WRITE] = 1;
+            }
+            else {
+                Pipeline_Encode(self, slot, uslot->data[URING_WRITE]);
+                uslot->size[URING_WRITE] = (unsigned)((long)slot->count * self->output_frame_size);
+                uslot->done[URING_WRITE] = 0;
+                uslot->offset[URING_WRITE] = writer->offset;
+                if (writer->seekable) {
+                    writer->offset += uslot->size[URING_WRITE];
+                }
+                if (uslot->size[URING_WRITE]) {
+                    PipelineUring_Queue(ctx, index, URING_WRITE);
+                }
+                else {
+                    uslot->ready[URING_WRITE] = 1;
+                }
+            }
+            self->write_time += Clock_Seconds() - start_time;
+        }
+
+        // Slots written completely are free again
+        while (release_seq < write_seq && ctx->slots[release_seq % slot_count].ready[URING_WRITE]) {
+            if (writer->enabled) {
+                self->total_frames += (long long)self->slots[release_seq % slot_count].count;
+            }
+            ++release_seq;
+            progress = 1;
+        }
+
+        if (!ctx->inflight && !progress) {
+            if (!finished && !ctx->error) {
+                fprintf(stderr, "io_uring pipeline stalled\n");
+                ctx->error = 1;
+            }
+            break;
+        }
+
+        // Submits, and waits for completions only if stuck
+        if (!Uring_Submit(&ctx->uring, (progress ? 0u : 1u))) {
+            perror("io_uring_enter()");
+            ctx->error = 1;
+            break;
+        }
+        PipelineUring_Reap(ctx);
+    }
+
+    // Leaves the file positions after the data transferred
+    if (reader->seekable && process_seq) {
+        UringSlot const* slot = &ctx->slots[(process_seq - 1) % slot_count];
+        SEEK_FD(reader->fd, (long long)(slot->offset[URING_READ] + slot->done[URING_READ]), SEEK_SET);
+    }
+    if (writer->seekable) {
+        SEEK_FD(writer->fd, (long long)writer->offset, SEEK_SET);
+    }
+    if (ctx->error) {
+        Atomic_Store(&self->error, 1);
+    }
+    Uring_Exit(&ctx->uring);
+
+end:
+    for (unsigned long s = 0; s < slot_count; ++s) {
+        free(ctx->slots[s].data[URING_WRITE]);
+        free(ctx->slots[s].data[URING_READ]);
+    }
+    free(ctx);
+    return available;
+}
+
+
+// Segment-parallel rendering of a memory-mapped input file: each worker
+// renders a contiguous segment from zero state, after warming up on the
+// preceding overlap frames, so that the filter tails converge.
+typedef struct SegmentJob {
+    Args const* args;
+    TDA8425_Chip const* prototype;
+    uint8_t const* input;
+    uint8_t* output;
+    TDA8425_Float* rendered;  // optional copy of the outputs, for checking
+    long input_frame_size;
+    long output_frame_size;
+    long block_frames;
+    long long frames;
+    long long segment_frames;
+    long long overlap;
+    unsigned long volatile error;
+} SegmentJob;
+
+
+static void SegmentTask(void* arg, TDA8425_Index index)
+{
+    SegmentJob* job = (SegmentJob*)arg;
+    Args const* args = job->args;
+    long long first = (long long)index * job->segment_frames;
+    long long end = first + job->segment_frames;
+    long long warmup = first - job->overlap;
+    if (end > job->frames) {
+        end = job->frames;
+    }
+    if (warmup < 0) {
+        warmup = 0;
+    }
+
+    long channels = (args->channels > MAX_OUTPUTS ? args->channels : MAX_OUTPUTS);
+    TDA8425_Chip* chip = (TDA8425_Chip*)malloc(sizeof(TDA8425_Chip));
+    TDA8425_Chip_Process_Data* frames = ((TDA8425_Chip_Process_Data*)
+                                         malloc((size_t)job->block_frames * sizeof(TDA8425_Chip_Process_Data)));
+    TDA8425_Float* samples = (TDA8425_Float*)malloc((size_t)(job->block_frames * channels) * sizeof(TDA8425_Float));
+
+    if (chip && frames && samples) {
+        *chip = *job->prototype;
+
+        for (long long pos = warmup; pos < end; ) {
+            long long remaining = end - pos;
+            TDA8425_Index count = (TDA8425_Index)(remaining < job->block_frames ? remaining : job->block_frames);
+
+            args->format->decoder(samples, &job->input[pos * job->input_frame_size],
+                                  (size_t)count * (size_t)args->channels);
+            ScatterInputs(args, samples, frames, (TDA8425_Index)job->block_frames, count);
+            TDA8425_Chip_ProcessBlock(chip, frames, count);
+
+            if (pos + (long long)count > first) {
+                TDA8425_Index skip = (TDA8425_Index)(pos < first ? first - pos : 0);  // warm-up
+                TDA8425_Index kept = count - skip;
+                long long offset = pos + (long long)skip;
+
+                GatherOutputs(args, &frames[skip], (TDA8425_Index)job->block_frames, kept, samples);
+                args->format->encoder(&job->output[offset * job->output_frame_size], samples,
+                                      (size_t)kept * (size_t)MAX_OUTPUTS);
+                if (job->rendered) {
+                    memcpy(&job->rendered[offset * MAX_OUTPUTS], samples,
+                           (size_t)kept * (size_t)MAX_OUTPUTS * sizeof(TDA8425_Float));
+                }
+            }
+            pos += (long long)count;
+        }
+    }
+    else {
+        Atomic_Store(&job->error, 1);
+    }
+
+    free(samples);
+    free(frames);
+    free(chip);
+}
+
+
+// Shortest overlap after which the tails of the impulse responses, from any
+// input to any output, sum up below the given error. For full-scale inputs,
+// this bounds the output error of a warm-up from zero state.
+static long long GetSegmentOverlap(Args const* args, TDA8425_Chip const* prototype,
+                                   double error, long long limit)
+{
+    double* tails = (double*)calloc((size_t)(limit * MAX_OUTPUTS + 1), sizeof(double));
+    if (!tails) {
+        return limit;
+    }
+
+    for (long input = 0; input < MAX_INPUTS; ++input) {
+        TDA8425_Chip chip = *prototype;
+        if (args->routes[0][input] < 0) {
+            continue;
+        }
+
+        for (long long k = 0; k < limit; ++k) {
+            TDA8425_Chip_Process_Data data;
+            TDA8425_Float* inputs = &data.inputs[0][0];  // overflows
+            for (long channel = 0; channel < MAX_INPUTS; ++channel) {
+                inputs[channel] = (TDA8425_Float)(!k && channel == input);
+            }
+            TDA8425_Chip_Process(&chip, &data);
+
+            for (long channel = 0; channel < MAX_OUTPUTS; ++channel) {
+                tails[k * MAX_OUTPUTS + channel] += fabs((double)data.outputs[channel]);
+            }
+        }
+    }
+
+    double sums[TDA8425_Stereo_Count] = { 0, 0 };
+    long long overlap = limit;
+    for (long long k = limit - 1; k >= 0; --k) {
+        int below = 1;
+        for (long channel = 0; channel < MAX_OUTPUTS; ++channel) {
+            sums[channel] += tails[k * MAX_OUTPUTS + channel];
+            below &= (sums[channel] < error);
+        }
+        if (!below) {
+            break;
+        }
+        overlap = k;
+    }
+
+    free(tails);
+    return overlap;
+}
+
+
+static int RunSegmented(Args const* args, TDA8425_Chip const* prototype, Input const* input)
+{
+    Output output;
+    int error = 0;
+
+    if (!input->mapped) {
+        fprintf(stderr, "Segmented rendering requires a regular --input file\n");
+        return 1;
+    }
+    if (args->chips > 1) {
+        fprintf(stderr, "Segmented rendering supports a single chip\n");
+        return 1;
+    }
+
+    SegmentJob job;
+    memset(&job, 0, sizeof(job));
+    job.args = args;
+    job.prototype = prototype;
+    job.input = input->data;
+    job.input_frame_size = args->channels * (long)args->format->size;
+    job.output_frame_size = MAX_OUTPUTS * (long)args->format->size;
+    job.block_frames = (args->block_frames > 0 ? args->block_frames : DEFAULT_BLOCK_FRAMES);
+    job.frames = (long long)(input->size / (uint64_t)job.input_frame_size);
+    job.segment_frames = (job.frames + args->jobs - 1) / args->jobs;
+    job.overlap = args->segment_overlap;
+    if (job.overlap <= 0) {
+        long long limit = (long long)(args->rate * MAX_OVERLAP_SECONDS);
+        job.overlap = GetSegmentOverlap(args, prototype, args->segment_error,
+                                        (job.frames < limit ? job.frames : limit));
+    }
+
+    size_t output_size = (size_t)job.frames * (size_t)job.output_frame_size;
+    void* output_buffer = NULL;
+    if (!Output_Open(&output, args, input, (uint64_t)output_size)) {
+        return 1;
+    }
+    if (output.mapped) {
+        job.output = output.data;
+    }
+    else {
+        output_buffer = malloc(output_size ? output_size : 1);
+        job.output = (uint8_t*)output_buffer;
+        error |= !output_buffer;
+    }
+    if (args->segment_check) {
+        job.rendered = (TDA8425_Float*)malloc((size_t)(job.frames * MAX_OUTPUTS + 1) * sizeof(TDA8425_Float));
+        error |= !job.rendered;
+    }
+    if (error) {
+        perror("malloc()");
+        goto end;
+    }
+
+    double start_time = Clock_Seconds();
+    if (job.frames) {
+        WorkerPool pool;
+        WorkerPool_Start(&pool, args->jobs);
+        WorkerPool_ForEach(&pool, SegmentTask, &job, (TDA8425_Index)args->jobs);
+        WorkerPool_Stop(&pool);
+    }
+    if (Atomic_Load(&job.error)) {
+        perror("malloc()");
+        error = 1;
+        goto end;
+    }
+    double elapsed = Clock_Seconds() - start_time;
+
+    if (!output.mapped && !WriteFully(output.fd, output_buffer, (long)output_size)) {
+        perror("write()");
+        error = 1;
+        goto end;
+    }
+
+    long trailing = (long)(input->size % (uint64_t)job.input_frame_size);
+    if (trailing) {
+        fprintf(stderr, "Discarded incomplete trailing frame: %ld bytes\n", trailing);
+    }
+
+    if (args->stats) {
+        if (elapsed <= 0) {
+            elapsed = 1e-9;
+        }
+        fprintf(stderr, "Frames:       %lld\n", job.frames);
+        fprintf(stderr, "Segments:     %ld x %lld frames\n", args->jobs, job.segment_frames);
+        fprintf(stderr, "Overlap:      %lld frames, %.3f ms\n", job.overlap,
+                (double)job.overlap * 1000 / (double)args->rate);
+        fprintf(stderr, "Elapsed:      %.6f s\n", elapsed);
+        fprintf(stderr, "Frame rate:   %.0f frames/s\n", (double)job.frames / elapsed);
+        fprintf(stderr, "Realtime:     %.2fx\n", (double)job.frames / (double)args->rate / elapsed);
+    }
+
+    if (job.rendered) {
+        // Serial reference render
+        TDA8425_Chip chip = *prototype;
+        SegmentJob serial = job;
+        double deviation = 0;
+        serial.args = args;
+        serial.prototype = &chip;
+        serial.segment_frames = job.frames;
+        serial.overlap = 0;
+        serial.rendered = (TDA8425_Float*)malloc((size_t)(job.frames * MAX_OUTPUTS + 1) * sizeof(TDA8425_Float));
+        serial.output = (uint8_t*)malloc(output_size ? output_size : 1);
+        if (!serial.rendered || !serial.output) {
+            perror("malloc()");
+            error = 1;
+        }
+        else {
+            SegmentTask(&serial, 0);
+            for (long long i = 0; i < job.frames * MAX_OUTPUTS; ++i) {
+                double delta = fabs((double)job.rendered[i] - (double)serial.rendered[i]);
+                if (deviation < delta) {
+                    deviation = delta;
+                }
+            }
+            fprintf(stderr, "Deviation:    %g max, %.1f dBFS\n", deviation,
+                    deviation > 0 ? 20 * log10(deviation) : -INFINITY);
+        }
+        free(serial.output);
+        free(serial.rendered);
+    }
+
+end:
+    free(job.rendered);
+    free(output_buffer);
+    error |= Output_Close(&output, (uint64_t)output_size);
+    return error;
+}
+
+
+// Loads the --events, if any; returns 0 on errors
+static int LoadEvents(Args const* args, EventList* events)
+{
+    events->events = NULL;
+    events->count = 0;
+    if (args->events_path) {
+        char const* message = (args->segmented ? "Register events are not supported by --segmented" :
+                               EventList_Load(events, args->events_path));
+        for (size_t e = 0; !message && e < events->count; ++e) {
+            if ((long)(events->events[e].address >> 4) >= args->chips) {
+                message = "Register event chip out of range";
+                EventList_Free(events);
+            }
+        }
+        if (message) {
+            fprintf(stderr, "%s: %s\n", args->events_path, message);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+static void SetupChip(Args const* args, TDA8425_Chip* chip, long index)
+{
+    TDA8425_Register const* regs = args->regs[index];
+
+    TDA8425_Chip_Ctor(chip);
+    TDA8425_Chip_Setup(chip, args->rate, args->pseudo_c1, args->pseudo_c2, args->tfilter_mode);
+    TDA8425_Chip_Reset(chip);
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_VL, regs[TDA8425_RegOrder_VL]);
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_VR, regs[TDA8425_RegOrder_VR]);
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_BA, regs[TDA8425_RegOrder_BA]);
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_TR, regs[TDA8425_RegOrder_TR]);
+    TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_SF, regs[TDA8425_RegOrder_SF]);
+    TDA8425_Chip_Start(chip);
+}
+
+
+// Converts a linear level into dBFS
+static double LevelToDecibels(double level)
+{
+    return (level > 0 ? 20 * log10(level) : -INFINITY);
+}
+
+
+// Prints the output levels of a chip, and the headroom left within the chain,
+// which the output clamping of the sample formats would otherwise hide
+static void PrintMeter(TDA8425_Meter const* meter, long index)
+{
+    static char const* const CHANNEL_LABELS[TDA8425_Stereo_Count] = { "L", "R" };
+
+    fprintf(stderr, "Chip %ld levels:\n", index);
+    for (int channel = 0; channel < TDA8425_Stereo_Count; ++channel) {
+        fprintf(stderr, "  %s: peak %.2f dBFS, RMS %.2f dBFS, clipped %llu", CHANNEL_LABELS[channel],
+                LevelToDecibels(meter->peak[channel]),
+                LevelToDecibels(TDA8425_Meter_GetRms(meter, (TDA8425_Stereo)channel)),
+                (unsigned long long)meter->clips[channel]);
+
+        // Chunked processing meters the outputs only
+        if (meter->peak[channel] > 0 && meter->volume_peak[channel] <= 0) {
+            fprintf(stderr, ", headroom: n/a\n");
+        }
+        else {
+            fprintf(stderr, ", headroom: volume %.2f dB, bass %.2f dB\n",
+                    -LevelToDecibels(meter->volume_peak[channel]), -LevelToDecibels(meter->bass_peak[channel]));
+        }
+    }
+}
+
+
+// Prints the hot-path counters of a chip, if built with TDA8425_USE_COUNTERS
+static void PrintCounters(TDA8425_Chip const* chip, long index)
+{
+    static char const* const STAGE_LABELS[TDA8425_Stage_Count] = {
+        "selector", "DC removal", "mode", "tone", "T-filter"
+    };
+    TDA8425_Counters counters;
+
+    if (!TDA8425_Chip_GetCounters(chip, &counters)) {
+        return;
+    }
+    fprintf(stderr, "Chip %ld:\n", index);
+    fprintf(stderr, "  Frames:       %llu, block: %llu, muted: %llu\n", (unsigned long long)counters.frames,
+            (unsigned long long)counters.block_frames, (unsigned long long)counters.idle_frames);
+    fprintf(stderr, "  Writes:       VL %llu, VR %llu, BA %llu, TR %llu, PP %llu, SF %llu\n",
+            (unsigned long long)counters.writes[TDA8425_RegOrder_VL],
+            (unsigned long long)counters.writes[TDA8425_RegOrder_VR],
+            (unsigned long long)counters.writes[TDA8425_RegOrder_BA],
+            (unsigned long long)counters.writes[TDA8425_RegOrder_TR],
+            (unsigned long long)counters.writes[TDA8425_RegOrder_PP],
+            (unsigned long long)counters.writes[TDA8425_RegOrder_SF]);
+    fprintf(stderr, "  Updates:      %llu coefficients, %llu blocks, %llu mode switches\n",
+            (unsigned long long)counters.coefficient_updates, (unsigned long long)counters.block_updates,
+            (unsigned long long)counters.mode_switches);
+    for (int s = 0; s < TDA8425_Stage_Count; ++s) {
+        fprintf(stderr, "  %-13s %llu cycles, %llu bypassed frames\n", STAGE_LABELS[s],
+                (unsigned long long)counters.stage_cycles[s], (unsigned long long)counters.bypass_frames[s]);
+    }
+    fprintf(stderr, "  Other cycles: write %llu, block update %llu, chunked %llu\n",
+            (unsigned long long)counters.write_cycles, (unsigned long long)counters.update_cycles,
+            (unsigned long long)counters.chunked_cycles);
+}
+
+
+// Attaches a recorder to each chip, and records the initial registers at
+// frame 0, so that the recording replays with default registers
+static int Pipeline_StartRecording(Pipeline* self)
+{
+    static TDA8425_Reg const INITIAL_REGS[] = {
+        TDA8425_Reg_VL, TDA8425_Reg_VR, TDA8425_Reg_BA, TDA8425_Reg_TR, TDA8425_Reg_SF
+    };
+    long const chips = self->args->chips;
+    size_t const initial_count = sizeof(INITIAL_REGS) / sizeof(INITIAL_REGS[0]);
+
+    self->record_capacity = self->events->count + initial_count;
+    self->recorders = (TDA8425_Recorder*)malloc((size_t)chips * sizeof(TDA8425_Recorder));
+    self->records = ((TDA8425_WriteRecord*)
+                     malloc((size_t)chips * self->record_capacity * sizeof(TDA8425_WriteRecord)));
+    if (!self->recorders || !self->records) {
+        perror("malloc()");
+        return 0;
+    }
+
+    for (long c = 0; c < chips; ++c) {
+        TDA8425_Chip* chip = &self->chips[c];
+        TDA8425_Recorder_Setup(&self->recorders[c], &self->records[(size_t)c * self->record_capacity],
+                               (TDA8425_Index)self->record_capacity);
+        TDA8425_Chip_SetRecorder(chip, &self->recorders[c]);
+
+        // Rewriting the current values does not alter the chip
+        for (size_t r = 0; r < initial_count; ++r) {
+            TDA8425_Address address = (TDA8425_Address)INITIAL_REGS[r];
+            TDA8425_Chip_Write(chip, address, TDA8425_Chip_Read(chip, address));
+        }
+    }
+    return 1;
+}
+
+
+// Merges the recordings of all the chips into the --record file
+static int Pipeline_SaveRecording(Pipeline* self)
+{
+    Args const* args = self->args;
+    long const chips = args->chips;
+    size_t const capacity = self->record_capacity;
+    TDA8425_WriteRecord* records = ((TDA8425_WriteRecord*)
+                                    malloc((size_t)chips * capacity * sizeof(TDA8425_WriteRecord)));
+    size_t* counts = (size_t*)calloc((size_t)chips, sizeof(size_t));
+    size_t* heads = (size_t*)calloc((size_t)chips, sizeof(size_t));
+    EventList recording;
+
+    recording.count = 0;
+    recording.events = (Event*)malloc((size_t)chips * capacity * sizeof(Event));
+    if (!records || !counts || !heads || !recording.events) {
+        perror("malloc()");
+        free(recording.events);
+        free(heads);
+        free(counts);
+        free(records);
+        return 0;
+    }
+
+    for (long c = 0; c < chips; ++c) {
+        counts[c] = TDA8425_Recorder_Read(&self->recorders[c], &records[(size_t)c * capacity],
+                                          (TDA8425_Index)capacity);
+        TDA8425_Chip_SetRecorder(&self->chips[c], NULL);
+    }
+
+    // Merged by frame index, keeping the write order of each chip
+    for (;;) {
+        long next = -1;
+        for (long c = 0; c < chips; ++c) {
+            if (heads[c] < counts[c] &&
+                (next < 0 || (records[(size_t)c * capacity + heads[c]].frame <
+                              records[(size_t)next * capacity + heads[next]].frame))) {
+                next = c;
+            }
+        }
+        if (next < 0) {
+            break;
+        }
+        TDA8425_WriteRecord const* record = &records[(size_t)next * capacity + heads[next]++];
+        Event* event = &recording.events[recording.count++];
+        event->frame = record->frame;
+        event->address = (TDA8425_Address)(((unsigned)next << 4) | (record->address & 0x0F));
+        event->data = record->data;
+    }
+
+    char const* message = EventList_Save(&recording, args->record_path);
+    if (message) {
+        fprintf(stderr, "%s: %s\n", args->record_path, message);
+    }
+    free(recording.events);
+    free(heads);
+    free(counts);
+    free(records);
+    return !message;
+}
+
+
+static int RunSweep(Args const* args, Input* input);
+
+
+// Gets the first option set that batch jobs do not support, or NULL
+static char const* Args_FindBatchUnsupported(Args const* args)
+{
+    for (int axis = 0; axis < Sweep_Count; ++axis) {
+        if (args->sweep_counts[axis]) {
+            return "--sweep";
+        }
+    }
+    if (args->record_path) {
+        return "--record";
+    }
+    if (args->segmented || args->segment_check) {
+        return "--segmented";
+    }
+    if (args->io_uring) {
+        return "--io-uring";
+    }
+    if (args->generator != Generator_None) {
+        return "--generate";
+    }
+    if (args->input_path) {
+        return "--input";  // given by the manifest
+    }
+    if (args->output_path) {
+        return "--output";
+    }
+    return NULL;
+}
+
+
+static int Run(Args* args)
+{
+    Input input;
+    Output output;
+    if (args->batch_path) {
+        char const* option = Args_FindBatchUnsupported(args);
+        if (option) {
+            fprintf(stderr, "--batch does not support %s\n", option);
+            return 1;
+        }
+        return RunBatch(args);
+    }
+    if (!Input_Open(&input, args)) {
+        return 1;
+    }
+    if (!Args_ResolveRoutes(args)) {
+        Input_Close(&input);
+        return 1;
+    }
+
+    EventList events;
+    if (!LoadEvents(args, &events)) {
+        Input_Close(&input);
+        return 1;
+    }
+
+    int sweeping = 0;
+    for (int axis = 0; axis < Sweep_Count; ++axis) {
+        sweeping |= (args->sweep_counts[axis] != 0);
+    }
+    if (sweeping) {
+        int error = 1;
+        if (args->events_path || args->record_path || args->segmented) {
+            fprintf(stderr, "--sweep does not support --events, --record, nor --segmented\n");
+        }
+        else {
+            error = RunSweep(args, &input);
+        }
+        EventList_Free(&events);
+        Input_Close(&input);
+        return error;
+    }
+
+    if (args->segmented) {
+        if (args->record_path) {
+            fprintf(stderr, "--segmented does not support --record\n");
+            Input_Close(&input);
+            return 1;
+        }
+        TDA8425_Chip* prototype = (TDA8425_Chip*)malloc(sizeof(TDA8425_Chip));
+        if (!prototype) {
+            perror("malloc()");
+            Input_Close(&input);
+            return 1;
+        }
+        SetupChip(args, prototype, 0);
+        int error = RunSegmented(args, prototype, &input);
+        TDA8425_Chip_Stop(prototype);
+        TDA8425_Chip_Dtor(prototype);
+        free(prototype);
+        Input_Close(&input);
+        return error;
+    }
+
+    Pipeline* self = (Pipeline*)calloc(1, sizeof(Pipeline));
+    if (!self) {
+        perror("calloc()");
+        EventList_Free(&events);
+        Input_Close(&input);
+        return 1;
+    }
+    self->args = args;
+    self->input_frame_size = args->channels * (long)args->format->size;
+    self->output_frame_size = args->chips * MAX_OUTPUTS * (long)args->format->size;
+    self->input = &input;
+    self->output = &output;
+    self->events = &events;
+
+    // Block sizing
+    long block_frames = args->block_frames;
+    long slot_count = args->throughput ? MAX_SLOTS / 2 : 4;
+    if (block_frames < 1) {
+        block_frames = args->buffer_size / self->input_frame_size;
+    }
+    if (args->chips == 1 && args->jobs > 1 && block_frames < JOB_FRAMES * args->jobs) {
+        block_frames = JOB_FRAMES * args->jobs;  // worth splitting
+    }
+    if (args->latency > 0) {
+        // At most one block per stage, all within the target
+        long queued = (long)(args->rate * args->latency / 1000);
+        slot_count = 3;
+        if (block_frames > queued / slot_count) {
+            block_frames = queued / slot_count;
+        }
+    }
+    if (block_frames < 1) {
+        block_frames = 1;
+    }
+    self->block_frames = block_frames;
+    self->slot_count = slot_count;
+
+    // Memory-mapped files are decoded from and encoded to directly
+    uint64_t output_size = WAVE_UNKNOWN_SIZE;
+    if (input.mapped || input.generated) {
+        output_size = ((input.size / (uint64_t)self->input_frame_size) *
+                       (uint64_t)self->output_frame_size);
+    }
+    if (!Output_Open(&output, args, &input, output_size)) {
+        EventList_Free(&events);
+        Input_Close(&input);
+        free(self);
+        return 1;
+    }
+
+    int error = 0;
+    self->chips = (TDA8425_Chip*)malloc((size_t)args->chips * sizeof(TDA8425_Chip));
+    self->input_samples = (TDA8425_Float*)malloc((size_t)(block_frames * args->channels) * sizeof(TDA8425_Float));
+    self->output_samples = ((TDA8425_Float*)
+                            malloc((size_t)(block_frames * args->chips * MAX_OUTPUTS) * sizeof(TDA8425_Float)));
+    if (!input.mapped && !input.generated) {
+        self->input_buffer = malloc((size_t)(block_frames * self->input_frame_size));
+        error |= !self->input_buffer;
+    }
+    if (!output.mapped) {
+        self->output_buffer = malloc((size_t)(block_frames * self->output_frame_size));
+        error |= !self->output_buffer;
+    }
+    for (long s = 0; s < slot_count; ++s) {
+        self->slots[s].frames = ((TDA8425_Chip_Process_Data*)
+                                 malloc((size_t)(block_frames * args->chips) * sizeof(TDA8425_Chip_Process_Data)));
+        error |= !self->slots[s].frames;
+    }
+    error |= !self->chips || !self->input_samples || !self->output_samples;
+    if (error) {
+        perror("malloc()");
+        goto end;
+    }
+
+    for (long c = 0; c < args->chips; ++c) {
+        SetupChip(args, &self->chips[c], c);
+    }
+    if (args->stats) {
+        self->meters = (TDA8425_Meter*)malloc((size_t)args->chips * sizeof(TDA8425_Meter));
+        if (!self->meters) {
+            perror("malloc()");
+            error = 1;
+            goto end;
+        }
+        for (long c = 0; c < args->chips; ++c) {
+            TDA8425_Meter_Reset(&self->meters[c]);
+            TDA8425_Chip_SetMeter(&self->chips[c], &self->meters[c]);
+        }
+    }
+    if (args->record_path && !Pipeline_StartRecording(self)) {
+        error = 1;
+        goto end;
+    }
+
+    // Created once, as spans between register events can be short
+    WorkerPool_Start(&self->pool, args->jobs);
+
+    double start_time = Clock_Seconds();
+    Thread reader;
+    Thread writer;
+    char const* backend = "threads";
+    char const* uring_reason = NULL;
+
+    if (args->io_uring && Pipeline_RunUring(self, &uring_reason)) {
+        backend = "io_uring";
+    }
+    else if (Thread_Start(&reader, Pipeline_ReaderRoutine, self)) {
+        if (Thread_Start(&writer, Pipeline_WriterRoutine, self)) {
+            Pipeline_RunThreaded(self, 0);
+            Thread_Join(&writer);
+        }
+        else {
+            Pipeline_RunThreaded(self, 1);
+        }
+        Thread_Join(&reader);
+    }
+    else {
+        Pipeline_RunSerial(self);
+    }
+    WorkerPool_Stop(&self->pool);
+    error = (int)Atomic_Load(&self->error);
+
+    if (self->trailing) {
+        fprintf(stderr, "Discarded incomplete trailing frame: %ld bytes\n", self->trailing);
+    }
+
+    if (args->stats) {
+        double elapsed = Clock_Seconds() - start_time;
+        double input_bytes = (double)self->total_frames * (double)self->input_frame_size;
+        double output_bytes = (double)self->total_frames * (double)self->output_frame_size;
+        if (elapsed <= 0) {
+            elapsed = 1e-9;
+        }
+        fprintf(stderr, "Frames:       %lld\n", self->total_frames);
+        fprintf(stderr, "Block:        %ld frames x %ld slots\n", self->block_frames, self->slot_count);
+        if (uring_reason) {
+            fprintf(stderr, "I/O backend:  %s (io_uring: %s)\n", backend, uring_reason);
+        }
+        else {
+            fprintf(stderr, "I/O backend:  %s\n", backend);
+        }
+        fprintf(stderr, "Elapsed:      %.6f s\n", elapsed);
+        fprintf(stderr, "Input:        %.0f B, %.3f MiB/s\n", input_bytes, input_bytes / elapsed / 1048576);
+        fprintf(stderr, "Output:       %.0f B, %.3f MiB/s\n", output_bytes, output_bytes / elapsed / 1048576);
+        fprintf(stderr, "Frame rate:   %.0f frames/s\n", (double)self->total_frames / elapsed);
+        fprintf(stderr, "Sample rate:  %.0f samples/s\n",
+                (double)self->total_frames * (double)args->channels / elapsed);
+        fprintf(stderr, "Realtime:     %.2fx\n", (double)self->total_frames / (double)args->rate / elapsed);
+        fprintf(stderr, "Read stage:   %.6f s, %.1f%%\n", self->read_time, self->read_time / elapsed * 100);
+        fprintf(stderr, "DSP stage:    %.6f s, %.1f%%\n", self->process_time, self->process_time / elapsed * 100);
+        fprintf(stderr, "Write stage:  %.6f s, %.1f%%\n", self->write_time, self->write_time / elapsed * 100);
+
+        for (long c = 0; c < args->chips; ++c) {
+            PrintMeter(&self->meters[c], c);
+            PrintCounters(&self->chips[c], c);
+        }
+    }
+
+    if (args->record_path && !error) {
+        error |= !Pipeline_SaveRecording(self);
+    }
+
+    for (long c = 0; c < args->chips; ++c) {
+        TDA8425_Chip_Stop(&self->chips[c]);
+        TDA8425_Chip_Dtor(&self->chips[c]);
+    }
+
+end:
+    for (long s = 0; s < slot_count; ++s) {
+        free(self->slots[s].frames);
+    }
+    free(self->output_buffer);
+    free(self->input_buffer);
+    free(self->output_samples);
+    free(self->input_samples);
+    free(self->records);
+    free(self->recorders);
+    free(self->meters);
+    free(self->chips);
+    error |= Output_Close(&output, (uint64_t)self->total_frames * (uint64_t)self->output_frame_size);
+    EventList_Free(&events);
+    Input_Close(&input);
+    free(self);
+    return error;
+}
+
+
+// Batch of jobs from a manifest, run by a pool of workers. Each worker keeps
+// its chips and buffers across jobs, and sets a chip up again only when its
+// static settings change, so that the coefficients of identical settings are
+// reused.
+typedef struct BatchJob {
+    Args args;
+    char* line;  // owns the words of args
+    long line_number;
+    int error;
+    int reused;  // chip setups
+    long long frames;
+    double elapsed;
+} BatchJob;
+
+
+typedef struct BatchChipKey {
+    int setup;  // static settings are valid
+    int written;  // registers are valid
+    TDA8425_Float rate;
+    TDA8425_Float pseudo_c1;
+    TDA8425_Float pseudo_c2;
+    TDA8425_Tfilter_Mode tfilter_mode;
+    TDA8425_Register regs[TDA8425_RegOrder_Count];
+} BatchChipKey;
+
+
+typedef struct Batch {
+    BatchJob* jobs;
+    unsigned long count;
+    unsigned long volatile next;  // job queue
+} Batch;
+
+
+typedef struct BatchWorker {
+    Batch* batch;
+    TDA8425_Chip chips[MAX_CHIPS];
+    BatchChipKey keys[MAX_CHIPS];
+    void* input_samples;
+    size_t input_samples_capacity;
+    void* output_samples;
+    size_t output_samples_capacity;
+    void* frames;
+    size_t frames_capacity;
+} BatchWorker;
+
+
+// Grows a reusable buffer; returns 0 on errors
+static int Reserve(void** buffer, size_t* capacity, size_t size)
+{
+    if (*capacity < size) {
+        void* grown = realloc(*buffer, size);
+        if (!grown) {
+            return 0;
+        }
+        *buffer = grown;
+        *capacity = size;
+    }
+    return 1;
+}
+
+
+// Sets a chip up for a job, reusing its coefficients if possible; returns
+// whether reused
+static int BatchWorker_SetupChip(BatchWorker* self, Args const* args, long index)
+{
+    TDA8425_Chip* chip = &self->chips[index];
+    BatchChipKey* key = &self->keys[index];
+    TDA8425_Register const* regs = args->regs[index];
+
+    if (!key->setup ||
+        key->rate != args->rate ||
+        key->pseudo_c1 != args->pseudo_c1 ||
+        key->pseudo_c2 != args->pseudo_c2 ||
+        key->tfilter_mode != args->tfilter_mode) {
+        if (key->setup) {
+            TDA8425_Chip_Stop(chip);
+            TDA8425_Chip_Dtor(chip);
+        }
+        SetupChip(args, chip, index);
+        key->setup = 1;
+        key->written = 1;
+        key->rate = args->rate;
+        key->pseudo_c1 = args->pseudo_c1;
+        key->pseudo_c2 = args->pseudo_c2;
+        key->tfilter_mode = args->tfilter_mode;
+        memcpy(key->regs, regs, sizeof(key->regs));
+        return 0;
+    }
+
+    // Events may have selected a pseudo preset: no preset restores the setup
+    // capacitors, as after SetupChip()
+    if (!key->written) {
+        TDA8425_Chip_Write(chip, (TDA8425_Address)TDA8425_Reg_PP, (TDA8425_Register)TDA8425_Pseudo_Data_Mask);
+    }
+
+    // Only the changed registers rebuild their coefficients
+    for (int r = 0; REGISTER_TABLE[r].label; ++r) {
+        TDA8425_RegOrder order = REGISTER_TABLE[r].order;
+        if (!key->written || key->regs[order] != regs[order]) {
+            TDA8425_Chip_Write(chip, (TDA8425_Address)REGISTER_TABLE[r].value, regs[order]);
+        }
+    }
+    key->written = 1;
+    memcpy(key->regs, regs, sizeof(key->regs));
+    TDA8425_Chip_Start(chip);
+    return 1;
+}
+
+
+static int BatchWorker_Run(BatchWorker* self, BatchJob* job)
+{
+    Args* args = &job->args;
+    Input input;
+    Output output;
+    EventList events = { NULL, 0 };
+    int error = 1;
+
+    if (!Input_Open(&input, args)) {
+        return 1;
+    }
+    if (!Args_ResolveRoutes(args) || !LoadEvents(args, &events)) {
+        Input_Close(&input);
+        return 1;
+    }
+
+    Pipeline pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.args = args;
+    pipeline.chips = self->chips;
+    pipeline.input_frame_size = args->channels * (long)args->format->size;
+    pipeline.output_frame_size = args->chips * MAX_OUTPUTS * (long)args->format->size;
+    pipeline.block_frames = (args->block_frames > 0 ? args->block_frames : DEFAULT_BLOCK_FRAMES);
+    pipeline.slot_count = 1;
+    pipeline.input = &input;
+    pipeline.output = &output;
+    pipeline.events = &events;
+
+    size_t block_frames = (size_t)pipeline.block_frames;
+    if (!Reserve(&self->input_samples, &self->input_samples_capacity,
+                 block_frames * (size_t)args->channels * sizeof(TDA8425_Float)) ||
+        !Reserve(&self->output_samples, &self->output_samples_capacity,
+                 block_frames * (size_t)(args->chips * MAX_OUTPUTS) * sizeof(TDA8425_Float)) ||
+        !Reserve(&self->frames, &self->frames_capacity,
+                 block_frames * (size_t)args->chips * sizeof(TDA8425_Chip_Process_Data))) {
+        perror("malloc()");
+        goto end;
+    }
+    pipeline.input_samples = (TDA8425_Float*)self->input_samples;
+    pipeline.output_samples = (TDA8425_Float*)self->output_samples;
+    pipeline.slots[0].frames = (TDA8425_Chip_Process_Data*)self->frames;
+
+    // Known size, so that the output file is memory-mapped
+    uint64_t output_size = ((input.size / (uint64_t)pipeline.input_frame_size) *
+                            (uint64_t)pipeline.output_frame_size);
+    if (!Output_Open(&output, args, &input, output_size)) {
+        goto end;
+    }
+
+    job->reused = 1;
+    for (long c = 0; c < args->chips; ++c) {
+        job->reused &= BatchWorker_SetupChip(self, args, c);
+        self->keys[c].written = !events.count;  // events change registers
+    }
+
+    Pipeline_RunSerial(&pipeline);
+    error = (int)Atomic_Load(&pipeline.error);
+    job->frames = pipeline.total_frames;
+    error |= Output_Close(&output, (uint64_t)pipeline.total_frames * (uint64_t)pipeline.output_frame_size);
+
+end:
+    EventList_Free(&events);
+    Input_Close(&input);
+    return error;
+}
+
+
+static THREAD_ROUTINE(BatchWorker_Routine, arg)
+{
+    BatchWorker* self = (BatchWorker*)arg;
+    Batch* batch = self->batch;
+
+    for (;;) {
+        unsigned long index = Atomic_FetchAdd(&batch->next, 1);
+        if (index >= batch->count) {
+            break;
+        }
+        BatchJob* job = &batch->jobs[index];
+        double start_time = Clock_Seconds();
+        job->error = BatchWorker_Run(self, job);
+        job->elapsed = Clock_Seconds() - start_time;
+    }
+    THREAD_RETURN;
+}
+
+
+// Splits a manifest line into words, with "double quoted" words and #
+// comments; returns the word count, or -1 if too many.
+static int SplitWords(char* line, char const* words[], int capacity)
+{
+    int count = 0;
+    char* ptr = line;
+
+    for (;;) {
+        while (*ptr == ' ' || *ptr == '\t' || *ptr == '\r' || *ptr == '\n') {
+            ++ptr;
+        }
+        if (!*ptr || *ptr == '#') {
+            break;
+        }
+        if (count >= capacity) {
+            return -1;
+        }
+        if (*ptr == '"') {
+            words[count++] = ++ptr;
+            while (*ptr && *ptr != '"') {
+                ++ptr;
+            }
+        }
+        else {
+            words[count++] = ptr;
+            while (*ptr && *ptr != ' ' && *ptr != '\t' && *ptr != '\r' && *ptr != '\n') {
+                ++ptr;
+            }
+        }
+        if (*ptr) {
+            *ptr++ = '\0';
+        }
+    }
+    return count;
+}
+
+
+// Parses the manifest into jobs, each starting from the given arguments;
+// returns 0 on errors.
+static int Batch_Load(Batch* self, Args const* args)
+{
+    FILE* file = fopen(args->batch_path, "r");
+    unsigned long capacity = 0;
+    long line_number = 0;
+    char buffer[4096];
+
+    if (!file) {
+        perror(args->batch_path);
+        return 0;
+    }
+
+    while (fgets(buffer, (int)sizeof(buffer), file)) {
+        char const* words[256];
+        char* line = (char*)malloc(strlen(buffer) + 1);
+        ++line_number;
+        if (!line) {
+            perror("malloc()");
+            fclose(file);
+            return 0;
+        }
+        strcpy(line, buffer);
+
+        int count = SplitWords(line, words, (int)(sizeof(words) / sizeof(words[0])));
+        if (!count) {
+            free(line);
+            continue;  // blank
+        }
+        if (self->count >= capacity) {
+            unsigned long grown = (capacity ? capacity * 2 : 64);
+            BatchJob* jobs = (BatchJob*)realloc(self->jobs, grown * sizeof(BatchJob));
+            if (!jobs) {
+                perror("realloc()");
+                free(line);
+                fclose(file);
+                return 0;
+            }
+            self->jobs = jobs;
+            capacity = grown;
+        }
+
+        BatchJob* job = &self->jobs[self->count++];
+        memset(job, 0, sizeof(*job));
+        job->args = *args;
+        job->args.batch_path = NULL;
+        job->line = line;
+        job->line_number = line_number;
+        errno = 0;
+        if (count < 2 || Args_Parse(&job->args, count - 2, &words[2]) >= 0) {
+            fprintf(stderr, "%s:%ld: Expecting INPUT OUTPUT [OPTION]...\n", args->batch_path, line_number);
+            fclose(file);
+            return 0;
+        }
+        char const* option = (job->args.batch_path ? "--batch" : Args_FindBatchUnsupported(&job->args));
+        if (option) {
+            fprintf(stderr, "%s:%ld: Not supported by batch jobs: %s\n", args->batch_path, line_number, option);
+            fclose(file);
+            return 0;
+        }
+        job->args.input_path = words[0];
+        job->args.output_path = words[1];
+        job->args.jobs = 1;  // parallel across jobs
+    }
+
+    fclose(file);
+    return 1;
+}
+
+
+static int RunBatch(Args const* args)
+{
+    Batch batch;
+    memset(&batch, 0, sizeof(batch));
+    int error = !Batch_Load(&batch, args);
+
+    long worker_count = args->jobs;
+    if ((unsigned long)worker_count > batch.count) {
+        worker_count = (long)batch.count;
+    }
+    BatchWorker* workers = NULL;
+    if (!error && worker_count) {
+        workers = (BatchWorker*)calloc((size_t)worker_count, sizeof(BatchWorker));
+        if (!workers) {
+            perror("calloc()");
+            error = 1;
+        }
+    }
+
+    if (!error) {
+        Thread threads[MAX_JOBS];
+        long started;
+        double start_time = Clock_Seconds();
+
+        // Worker 0 runs on the calling thread, also as fallback
+        for (long w = 0; w < worker_count; ++w) {
+            workers[w].batch = &batch;
+        }
+        for (started = 1; started < worker_count; ++started) {
+            if (!Thread_Start(&threads[started], BatchWorker_Routine, &workers[started])) {
+                break;
+            }
+        }
+        if (worker_count) {
+            BatchWorker_Routine(&workers[0]);
+        }
+        for (long w = 1; w < started; ++w) {
+            Thread_Join(&threads[w]);
+        }
+        double elapsed = Clock_Seconds() - start_time;
+
+        long long total_frames = 0;
+        unsigned long failed = 0;
+        printf("| Line | Status | Frames     | Elapsed [s] | Realtime  | Setup    | Output\n");
+        printf("|------|--------|------------|-------------|-----------|----------|-------\n");
+        for (unsigned long j = 0; j < batch.count; ++j) {
+            BatchJob const* job = &batch.jobs[j];
+            double realtime = (job->elapsed > 0 ? (double)job->frames / (double)job->args.rate / job->elapsed : 0);
+            printf("| %4ld | %-6s | %10lld | %11.6f | %8.2fx | %-8s | %s\n",
+                   job->line_number, job->error ? "error" : "ok", job->frames, job->elapsed, realtime,
+                   job->error ? "-" : job->reused ? "reused" : "computed", job->args.output_path);
+            total_frames += job->frames;
+            failed += (unsigned long)(job->error != 0);
+        }
+        error = (failed != 0);
+
+        if (args->stats) {
+            if (elapsed <= 0) {
+                elapsed = 1e-9;
+            }
+            fprintf(stderr, "Jobs:         %lu, %lu failed\n", batch.count, failed);
+            fprintf(stderr, "Workers:      %ld\n", worker_count);
+            fprintf(stderr, "Frames:       %lld\n", total_frames);
+            fprintf(stderr, "Elapsed:      %.6f s\n", elapsed);
+            fprintf(stderr, "Frame rate:   %.0f frames/s\n", (double)total_frames / elapsed);
+        }
+    }
+
+    for (long w = 0; w < worker_count && workers; ++w) {
+        for (long c = 0; c < MAX_CHIPS; ++c) {
+            if (workers[w].keys[c].setup) {
+                TDA8425_Chip_Stop(&workers[w].chips[c]);
+                TDA8425_Chip_Dtor(&workers[w].chips[c]);
+            }
+        }
+        free(workers[w].frames);
+        free(workers[w].output_samples);
+        free(workers[w].input_samples);
+    }
+    free(workers);
+    for (unsigned long j = 0; j < batch.count; ++j) {
+        free(batch.jobs[j].line);
+    }
+    free(batch.jobs);
+    return error;
+}
+
+
+// Register-space sweep: the input is decoded once into memory, then rendered
+// with one set of chips per configuration, in parallel. Each rendering writes
+// its own output, or just measures its levels.
+typedef struct SweepJob {
+    Args const* args;
+    Input const* input;
+    TDA8425_Float const* samples;  // decoded input
+    long long frames;
+    long block_frames;
+    long config_count;
+    double* levels;  // per configuration and output channel: sum of squares, peak
+    int* errors;
+} SweepJob;
+
+
+// Applies the registers of a configuration, in mixed radix of the sweep axes
+static void Sweep_GetConfig(Args const* args, long index, Args* config)
+{
+    *config = *args;
+    config->chip_selected = -1;
+
+    for (int axis = 0; axis < Sweep_Count; ++axis) {
+        long count = args->sweep_counts[axis];
+        if (count) {
+            TDA8425_Register value = args->sweep_values[axis][index % count];
+            index /= count;
+
+            if (axis == Sweep_Bass) {
+                Args_SetRegister(config, TDA8425_RegOrder_BA, 0xFF, value);
+            }
+            else if (axis == Sweep_Treble) {
+                Args_SetRegister(config, TDA8425_RegOrder_TR, 0xFF, value);
+            }
+            else {
+                Args_SetRegister(config, TDA8425_RegOrder_SF,
+                                 (TDA8425_Register)(TDA8425_Mode_Mask << TDA8425_Reg_SF_STL),
+                                 (TDA8425_Register)(value << TDA8425_Reg_SF_STL));
+            }
+        }
+    }
+}
+
+
+// Tag of a configuration, as per the registers of the first chip
+static void Sweep_FormatTag(Args const* config, char* tag, size_t size)
+{
+    TDA8425_Register const* regs = config->regs[0];
+    int mode = (int)((regs[TDA8425_RegOrder_SF] >> TDA8425_Reg_SF_STL) & TDA8425_Mode_Mask);
+    char const* label = "";
+
+    for (int j = 0; MODE_TABLE[j].label; ++j) {
+        if ((int)MODE_TABLE[j].value == mode) {
+            label = MODE_TABLE[j].label;
+        }
+    }
+    snprintf(tag, size, "BA%02X_TR%02X_%s", (unsigned)regs[TDA8425_RegOrder_BA],
+             (unsigned)regs[TDA8425_RegOrder_TR], label);
+}
+
+
+// Inserts the tag of a configuration into the output path: in place of %s,
+// else before the extension
+static void Sweep_FormatPath(char const* pattern, char const* tag, char* path, size_t size)
+{
+    char const* mark = strstr(pattern, "%s");
+    size_t skip = 2;
+
+    if (!mark) {
+        char const* slash = strrchr(pattern, '/');
+        char const* dot = strrchr(pattern, '.');
+        if (dot && (!slash || dot > slash)) {
+            mark = dot;
+            skip = 0;
+        }
+        else {
+            mark = pattern + strlen(pattern);
+            skip = 0;
+        }
+    }
+    snprintf(path, size, "%.*s%s%s%s", (int)(mark - pattern), pattern,
+             (skip ? "" : "."), tag, mark + skip);
+}
+
+
+static void SweepTask(void* arg, TDA8425_Index index)
+{
+    SweepJob* job = (SweepJob*)arg;
+    Args const* args = job->args;
+    long outputs = args->chips * MAX_OUTPUTS;
+    double* levels = &job->levels[(long)index * outputs * 2];
+    Output output;
+    int writing = (args->output_path != NULL && !args->null_output);
+    int error = 0;
+    char tag[64];
+    char path[4096];
+
+    Args config;
+    Sweep_GetConfig(args, (long)index, &config);
+    if (writing) {
+        Sweep_FormatTag(&config, tag, sizeof(tag));
+        Sweep_FormatPath(args->output_path, tag, path, sizeof(path));
+        config.output_path = path;
+    }
+
+    TDA8425_Chip* chips = (TDA8425_Chip*)malloc((size_t)args->chips * sizeof(TDA8425_Chip));
+    TDA8425_Chip_Process_Data* frames = ((TDA8425_Chip_Process_Data*)
+                                         malloc((size_t)(job->block_frames * args->chips) *
+                                                sizeof(TDA8425_Chip_Process_Data)));
+    TDA8425_Float* samples = (TDA8425_Float*)malloc((size_t)(job->block_frames * outputs) * sizeof(TDA8425_Float));
+    long output_frame_size = outputs * (long)args->format->size;
+
+    if (!chips || !frames || !samples) {
+        perror("malloc()");
+        error = 1;
+    }
+    else if (writing && !Output_Open(&output, &config, job->input,
+                                     (uint64_t)job->frames * (uint64_t)output_frame_size)) {
+        error = 1;
+    }
+    else {
+        for (long c = 0; c < args->chips; ++c) {
+            SetupChip(&config, &chips[c], c);
+        }
+
+        for (long long pos = 0; pos < job->frames; ) {
+            long long remaining = job->frames - pos;
+            TDA8425_Index count = (TDA8425_Index)(remaining < job->block_frames ? remaining : job->block_frames);
+
+            ScatterInputs(&config, &job->samples[pos * args->channels], frames,
+                          (TDA8425_Index)job->block_frames, count);
+            for (long c = 0; c < args->chips; ++c) {
+                TDA8425_Chip_ProcessBlock(&chips[c], &frames[(TDA8425_Index)c * (TDA8425_Index)job->block_frames],
+                                          count);
+            }
+            GatherOutputs(&config, frames, (TDA8425_Index)job->block_frames, count, samples);
+
+            for (TDA8425_Index i = 0; i < count; ++i) {
+                for (long channel = 0; channel < outputs; ++channel) {
+                    double sample = (double)samples[i * (TDA8425_Index)outputs + (TDA8425_Index)channel];
+                    double magnitude = fabs(sample);
+                    levels[channel * 2 + 0] += sample * sample;
+                    if (levels[channel * 2 + 1] < magnitude) {
+                        levels[channel * 2 + 1] = magnitude;
+                    }
+                }
+            }
+            if (writing) {
+                args->format->encoder(&output.data[pos * output_frame_size], samples,
+                                      (size_t)count * (size_t)outputs);
+            }
+            pos += (long long)count;
+        }
+
+        for (long c = 0; c < args->chips; ++c) {
+            TDA8425_Chip_Stop(&chips[c]);
+            TDA8425_Chip_Dtor(&chips[c]);
+        }
+        if (writing) {
+            error |= Output_Close(&output, (uint64_t)job->frames * (uint64_t)output_frame_size);
+        }
+    }
+
+    job->errors[index] = error;
+    free(samples);
+    free(frames);
+    free(chips);
+}
+
+
+static int RunSweep(Args const* args, Input* input)
+{
+    long input_frame_size = args->channels * (long)args->format->size;
+    long outputs = args->chips * MAX_OUTPUTS;
+    uint8_t const* data = input->data;
+    uint8_t* buffer = NULL;
+    uint64_t size = input->size;
+    int error = 0;
+
+    // Whole input in memory
+    if (!input->mapped && !input->generated) {
+        size_t capacity = 0;
+        size = 0;
+        for (;;) {
+            if (size == capacity) {
+                size_t grown = (capacity ? capacity * 2 : (size_t)1 << 20);
+                uint8_t* ptr = (uint8_t*)realloc(buffer, grown);
+                if (!ptr) {
+                    perror("realloc()");
+                    free(buffer);
+                    return 1;
+                }
+                buffer = ptr;
+                capacity = grown;
+            }
+            long result = Input_Read(input, &buffer[size], (long)(capacity - (size_t)size));
+            if (result < 0) {
+                perror("read()");
+                free(buffer);
+                return 1;
+            }
+            if (!result) {
+                break;
+            }
+            size += (uint64_t)result;
+        }
+        data = buffer;
+    }
+
+    SweepJob job;
+    memset(&job, 0, sizeof(job));
+    job.args = args;
+    job.input = input;
+    job.frames = (long long)(size / (uint64_t)input_frame_size);
+    job.block_frames = (args->block_frames > 0 ? args->block_frames : DEFAULT_BLOCK_FRAMES);
+    job.config_count = 1;
+    for (int axis = 0; axis < Sweep_Count; ++axis) {
+        if (args->sweep_counts[axis]) {
+            job.config_count *= args->sweep_counts[axis];
+        }
+    }
+
+    TDA8425_Float* samples = ((TDA8425_Float*)
+                              malloc((size_t)(job.frames * args->channels + 1) * sizeof(TDA8425_Float)));
+    job.levels = (double*)calloc((size_t)(job.config_count * outputs * 2), sizeof(double));
+    job.errors = (int*)calloc((size_t)job.config_count, sizeof(int));
+    if (!samples || !job.levels || !job.errors) {
+        perror("malloc()");
+        error = 1;
+        goto end;
+    }
+    if (input->generated) {
+        Generator_Render(&input->generator, samples, (size_t)job.frames);
+    }
+    else {
+        args->format->decoder(samples, data, (size_t)job.frames * (size_t)args->channels);
+    }
+    free(buffer);
+    buffer = NULL;
+    job.samples = samples;
+
+    double start_time = Clock_Seconds();
+    WorkerPool pool;
+    WorkerPool_Start(&pool, args->jobs);
+    WorkerPool_ForEach(&pool, SweepTask, &job, (TDA8425_Index)job.config_count);
+    WorkerPool_Stop(&pool);
+    double elapsed = Clock_Seconds() - start_time;
+
+    for (long k = 0; k < job.config_count; ++k) {
+        error |= job.errors[k];
+    }
+
+    if (!args->output_path) {
+        printf("| BA [dB] | TR [dB] | Mode    |");
+        for (long channel = 0; channel < outputs; ++channel) {
+            printf(" RMS %2ld%c [dBFS] |", channel / 2, "LR"[channel % 2]);
+        }
+        for (long channel = 0; channel < outputs; ++channel) {
+            printf(" Peak %2ld%c [dBFS] |", channel / 2, "LR"[channel % 2]);
+        }
+        printf("\n|---------|---------|---------|");
+        for (long channel = 0; channel < outputs; ++channel) {
+            printf("----------------|");
+        }
+        for (long channel = 0; channel < outputs; ++channel) {
+            printf("-----------------|");
+        }
+        printf("\n");
+
+        for (long k = 0; k < job.config_count; ++k) {
+            Args config;
+            char const* label = "";
+            double const* levels = &job.levels[k * outputs * 2];
+            Sweep_GetConfig(args, k, &config);
+            TDA8425_Register const* regs = config.regs[0];
+            int mode = (int)((regs[TDA8425_RegOrder_SF] >> TDA8425_Reg_SF_STL) & TDA8425_Mode_Mask);
+            for (int j = 0; MODE_TABLE[j].label; ++j) {
+                if ((int)MODE_TABLE[j].value == mode) {
+                    label = MODE_TABLE[j].label;
+                }
+            }
+
+            printf("| %+7d | %+7d | %-7s |",
+                   TDA8425_BassDecibel_Table[regs[TDA8425_RegOrder_BA] & TDA8425_Tone_Data_Mask],
+                   TDA8425_TrebleDecibel_Table[regs[TDA8425_RegOrder_TR] & TDA8425_Tone_Data_Mask],
+                   label);
+            for (long channel = 0; channel < outputs; ++channel) {
+                double rms = (job.frames ? sqrt(levels[channel * 2 + 0] / (double)job.frames) : 0);
+                printf(" %14.2f |", rms > 0 ? 20 * log10(rms) : -INFINITY);
+            }
+            for (long channel = 0; channel < outputs; ++channel) {
+                double peak = levels[channel * 2 + 1];
+                printf(" %15.2f |", peak > 0 ? 20 * log10(peak) : -INFINITY);
+            }
+            printf("\n");
+        }
+    }
+
+    if (args->stats) {
+        if (elapsed <= 0) {
+            elapsed = 1e-9;
+        }
+        double rendered = (double)job.frames * (double)job.config_count;
+        fprintf(stderr, "Frames:       %lld\n", job.frames);
+        fprintf(stderr, "Configs:      %ld\n", job.config_count);
+        fprintf(stderr, "Elapsed:      %.6f s\n", elapsed);
+        fprintf(stderr, "Frame rate:   %.0f frames/s\n", rendered / elapsed);
+        fprintf(stderr, "Realtime:     %.2fx\n", rendered / (double)args->rate / elapsed);
+    }
+
+end:
+    free(job.errors);
+    free(job.levels);
+    free(samples);
+    free(buffer);
+    return error;
+}
+
+
+static int RunFormatBenchmark(void)
+{
+    size_t const count = 1 << 16;  // cache resident
+    double const min_time = 0.1;
+
+    printf("| Format     | Decode [GB/s] | Encode [GB/s] |\n");
+    printf("|------------|---------------|---------------|\n");
+
+    for (SampleFormat const* format = SAMPLE_FORMAT_TABLE; format->label; ++format) {
+        double decode;
+        double encode;
+        if (!SampleFormat_Measure(format, count, min_time, &decode, &encode)) {
+            perror("malloc()");
+            return 1;
+        }
+        printf("| %-10s | %13.3f | %13.3f |\n", format->label, decode * 1e-9, encode * 1e-9);
+    }
+    return 0;
+}
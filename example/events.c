@@ -0,0 +1,242 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "events.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct EventRegisterTable {
+    char const* label;
+    TDA8425_Reg address;
+} const EVENT_REGISTER_TABLE[] =
+{
+    { "VL", TDA8425_Reg_VL },
+    { "VR", TDA8425_Reg_VR },
+    { "BA", TDA8425_Reg_BA },
+    { "TR", TDA8425_Reg_TR },
+    { "SF", TDA8425_Reg_SF },
+    { NULL, (TDA8425_Reg)0 }
+};
+
+// ============================================================================
+
+void Event_Encode(uint8_t record[EVENT_RECORD_SIZE], Event const* event)
+{
+    for (int i = 0; i < 8; ++i) {
+        record[i] = (uint8_t)(event->frame >> (i * 8));
+    }
+    record[8] = (uint8_t)event->address;
+    record[9] = (uint8_t)event->data;
+}
+
+// ----------------------------------------------------------------------------
+
+void Event_Decode(Event* event, uint8_t const record[EVENT_RECORD_SIZE])
+{
+    event->frame = 0;
+    for (int i = 0; i < 8; ++i) {
+        event->frame |= (uint64_t)record[i] << (i * 8);
+    }
+    event->address = (TDA8425_Address)record[8];
+    event->data = (TDA8425_Register)record[9];
+}
+
+// ----------------------------------------------------------------------------
+
+void EventList_Free(EventList* self)
+{
+    free(self->events);
+    self->events = NULL;
+    self->count = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+static char const* EventList_Append(EventList* self, size_t* capacity, Event const* event)
+{
+    if (self->count && self->events[self->count - 1].frame > event->frame) {
+        return "Events not sorted by frame index";
+    }
+    if (self->count >= *capacity) {
+        size_t grown = (*capacity ? *capacity * 2 : 256);
+        Event* events = (Event*)realloc(self->events, grown * sizeof(Event));
+        if (!events) {
+            return "Out of memory for events";
+        }
+        self->events = events;
+        *capacity = grown;
+    }
+    self->events[self->count++] = *event;
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+
+static char const* EventList_ParseLine(Event* event, char* line)
+{
+    char* hash = strchr(line, '#');
+    if (hash) {
+        *hash = '\0';
+    }
+
+    char* fields[3];
+    int count = 0;
+    for (char* token = strtok(line, " \t\r\n,"); token; token = strtok(NULL, " \t\r\n,")) {
+        if (count >= 3) {
+            return "Too many event fields";
+        }
+        fields[count++] = token;
+    }
+    if (!count) {
+        return "";  // blank
+    }
+    if (count < 3) {
+        return "Too few event fields";
+    }
+
+    char* end;
+    event->frame = (uint64_t)strtoull(fields[0], &end, 10);
+    if (*end || !isdigit((unsigned char)fields[0][0])) {
+        return "Invalid event frame index";
+    }
+
+    int r;
+    for (r = 0; EVENT_REGISTER_TABLE[r].label; ++r) {
+        if (!strcmp(fields[1], EVENT_REGISTER_TABLE[r].label)) {
+            break;
+        }
+    }
+    if (EVENT_REGISTER_TABLE[r].label) {
+        event->address = (TDA8425_Address)EVENT_REGISTER_TABLE[r].address;
+    }
+    else {
+        unsigned long address = strtoul(fields[1], &end, 0);
+        if (*end || address > 0xFF) {
+            return "Invalid event register";
+        }
+        event->address = (TDA8425_Address)address;
+    }
+
+    unsigned long data = strtoul(fields[2], &end, 16);
+    if (*end || data > 0xFF) {
+        return "Invalid event register value";
+    }
+    event->data = (TDA8425_Register)data;
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+
+char const* EventList_Load(EventList* self, char const* path)
+{
+    char const* message = NULL;
+    size_t capacity = 0;
+    uint8_t magic[EVENTS_MAGIC_SIZE];
+    Event event;
+
+    self->events = NULL;
+    self->count = 0;
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return "Cannot open events file";
+    }
+
+    size_t peeked = fread(magic, 1, sizeof(magic), file);
+    if (peeked == sizeof(magic) && !memcmp(magic, EVENTS_MAGIC, sizeof(magic))) {
+        uint8_t record[EVENT_RECORD_SIZE];
+        size_t size;
+        while ((size = fread(record, 1, sizeof(record), file)) == sizeof(record)) {
+            Event_Decode(&event, record);
+            message = EventList_Append(self, &capacity, &event);
+            if (message) {
+                break;
+            }
+        }
+        if (!message && size) {
+            message = "Truncated events record";
+        }
+    }
+    else {
+        char line[256];
+        rewind(file);
+        while (fgets(line, (int)sizeof(line), file)) {
+            message = EventList_ParseLine(&event, line);
+            if (message) {
+                if (!*message) {
+                    message = NULL;
+                    continue;  // blank
+                }
+                break;
+            }
+            message = EventList_Append(self, &capacity, &event);
+            if (message) {
+                break;
+            }
+        }
+    }
+    if (!message && ferror(file)) {
+        message = "Cannot read events file";
+    }
+
+    fclose(file);
+    if (message) {
+        EventList_Free(self);
+    }
+    return message;
+}
+
+// ----------------------------------------------------------------------------
+
+char const* EventList_Save(EventList const* self, char const* path)
+{
+    char const* message = NULL;
+    uint8_t record[EVENT_RECORD_SIZE];
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return "Cannot create events file";
+    }
+
+    if (fwrite(EVENTS_MAGIC, 1, EVENTS_MAGIC_SIZE, file) != EVENTS_MAGIC_SIZE) {
+        message = "Cannot write events file";
+    }
+    for (size_t e = 0; !message && e < self->count; ++e) {
+        Event_Encode(record, &self->events[e]);
+        if (fwrite(record, 1, sizeof(record), file) != sizeof(record)) {
+            message = "Cannot write events file";
+        }
+    }
+    if (fclose(file) && !message) {
+        message = "Cannot write events file";
+    }
+    return message;
+}
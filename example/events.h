@@ -0,0 +1,91 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Register write events, for automation of offline renders.
+//
+// Binary files start with EVENTS_MAGIC, followed by EVENT_RECORD_SIZE bytes
+// per event: the frame index as a 64-bit little-endian integer, then the
+// register address, then the register value.
+//
+// Text files hold one event per line: the frame index, the register label
+// (VL, VR, BA, TR, SF) or address, and the [0x]HEX value; '#' starts a
+// comment.
+//
+// Events must be sorted by frame index; events of the same frame are
+// applied in file order.
+
+#ifndef _EVENTS_H_
+#define _EVENTS_H_
+
+#include "TDA8425_emu.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EVENTS_MAGIC  "TDA8425E"
+
+enum {
+    EVENTS_MAGIC_SIZE = 8,
+    EVENT_RECORD_SIZE = 8 + 1 + 1
+};
+
+typedef struct Event {
+    uint64_t frame;            //!< Frame index, before which to write
+    TDA8425_Address address;   //!< Register address
+    TDA8425_Register data;     //!< Register value
+} Event;
+
+typedef struct EventList {
+    Event* events;  //!< Sorted by frame index
+    size_t count;
+} EventList;
+
+//! Loads a binary or text file; returns NULL on success, or an error message
+char const* EventList_Load(EventList* self, char const* path);
+
+//! Saves as a binary file; returns NULL on success, or an error message
+char const* EventList_Save(EventList const* self, char const* path);
+
+//! Frees the loaded events
+void EventList_Free(EventList* self);
+
+//! Encodes an event as a binary record
+void Event_Encode(uint8_t record[EVENT_RECORD_SIZE], Event const* event);
+
+//! Decodes an event from a binary record
+void Event_Decode(Event* event, uint8_t const record[EVENT_RECORD_SIZE]);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // !_EVENTS_H_
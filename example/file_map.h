@@ -0,0 +1,228 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Minimal portable memory-mapped files for the examples.
+
+#ifndef _FILE_MAP_H_
+#define _FILE_MAP_H_
+
+#if (defined(_WIN16) || defined(_WIN32) || defined(_WIN64)) && !defined(__WINDOWS__)
+#define __WINDOWS__
+#endif
+
+#include <stddef.h>
+
+#ifdef __WINDOWS__
+
+#include <fcntl.h>
+#include <io.h>
+#include <windows.h>
+
+typedef struct FileMap {
+    void* data;      //!< Mapped view; NULL if empty
+    size_t size;     //!< Mapped size [B]
+    HANDLE file;
+    HANDLE mapping;
+} FileMap;
+
+static inline void FileMap_Close(FileMap* self)
+{
+    if (self->data) {
+        UnmapViewOfFile(self->data);
+        self->data = NULL;
+    }
+    if (self->mapping) {
+        CloseHandle(self->mapping);
+        self->mapping = NULL;
+    }
+    if (self->file != INVALID_HANDLE_VALUE) {
+        CloseHandle(self->file);
+        self->file = INVALID_HANDLE_VALUE;
+    }
+    self->size = 0;
+}
+
+//! Maps a whole file for sequential reading; returns 0 on errors, or -1 if
+//! the file is not a disk file (e.g. a pipe), left open for FileMap_DetachStream()
+static inline int FileMap_OpenRead(FileMap* self, char const* path)
+{
+    LARGE_INTEGER size;
+    self->data = NULL;
+    self->size = 0;
+    self->mapping = NULL;
+    self->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (self->file == INVALID_HANDLE_VALUE) {
+        FileMap_Close(self);
+        return 0;
+    }
+    if (GetFileType(self->file) != FILE_TYPE_DISK) {
+        return -1;
+    }
+    if (!GetFileSizeEx(self->file, &size)) {
+        FileMap_Close(self);
+        return 0;
+    }
+    self->size = (size_t)size.QuadPart;
+    if (self->size) {
+        self->mapping = CreateFileMappingA(self->file, NULL, PAGE_READONLY, 0, 0, NULL);
+        self->data = self->mapping ? MapViewOfFile(self->mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (!self->data) {
+            FileMap_Close(self);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//! Hands over the file left open by FileMap_OpenRead() as a descriptor for
+//! sequential reading; returns -1 on errors
+static inline int FileMap_DetachStream(FileMap* self)
+{
+    int fd = _open_osfhandle((intptr_t)self->file, _O_RDONLY | _O_BINARY);
+    if (fd < 0) {
+        FileMap_Close(self);
+        return -1;
+    }
+    self->file = INVALID_HANDLE_VALUE;
+    return fd;
+}
+
+//! Creates a file of the given size, mapped for sequential writing; returns 0 on errors
+static inline int FileMap_CreateWrite(FileMap* self, char const* path, size_t size)
+{
+    self->data = NULL;
+    self->size = size;
+    self->mapping = NULL;
+    self->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (self->file == INVALID_HANDLE_VALUE) {
+        FileMap_Close(self);
+        return 0;
+    }
+    if (size) {
+        ULONGLONG size64 = (ULONGLONG)size;
+        self->mapping = CreateFileMappingA(self->file, NULL, PAGE_READWRITE,
+                                           (DWORD)(size64 >> 32), (DWORD)size64, NULL);
+        self->data = self->mapping ? MapViewOfFile(self->mapping, FILE_MAP_WRITE, 0, 0, 0) : NULL;
+        if (!self->data) {
+            FileMap_Close(self);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+#else  // POSIX
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef struct FileMap {
+    void* data;      //!< Mapped view; NULL if empty
+    size_t size;     //!< Mapped size [B]
+    int fd;
+} FileMap;
+
+static inline void FileMap_Close(FileMap* self)
+{
+    if (self->data) {
+        munmap(self->data, self->size);
+        self->data = NULL;
+    }
+    if (self->fd >= 0) {
+        close(self->fd);
+        self->fd = -1;
+    }
+    self->size = 0;
+}
+
+//! Maps a whole file for sequential reading; returns 0 on errors, or -1 if
+//! the file is not a regular file (e.g. a FIFO), left open for FileMap_DetachStream()
+static inline int FileMap_OpenRead(FileMap* self, char const* path)
+{
+    struct stat info;
+    self->data = NULL;
+    self->size = 0;
+    self->fd = open(path, O_RDONLY);
+    if (self->fd < 0 || fstat(self->fd, &info)) {
+        FileMap_Close(self);
+        return 0;
+    }
+    if (!S_ISREG(info.st_mode)) {
+        return -1;
+    }
+    self->size = (size_t)info.st_size;
+    if (self->size) {
+        void* data = mmap(NULL, self->size, PROT_READ, MAP_SHARED, self->fd, 0);
+        if (data == MAP_FAILED) {
+            FileMap_Close(self);
+            return 0;
+        }
+        self->data = data;
+        posix_madvise(self->data, self->size, POSIX_MADV_SEQUENTIAL);
+    }
+    return 1;
+}
+
+//! Hands over the file left open by FileMap_OpenRead() as a descriptor for
+//! sequential reading; returns -1 on errors
+static inline int FileMap_DetachStream(FileMap* self)
+{
+    int fd = self->fd;
+    self->fd = -1;
+    return fd;
+}
+
+//! Creates a file of the given size, mapped for sequential writing; returns 0 on errors
+static inline int FileMap_CreateWrite(FileMap* self, char const* path, size_t size)
+{
+    self->data = NULL;
+    self->size = size;
+    self->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (self->fd < 0 || ftruncate(self->fd, (off_t)size)) {
+        FileMap_Close(self);
+        return 0;
+    }
+    if (size) {
+        void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, self->fd, 0);
+        if (data == MAP_FAILED) {
+            FileMap_Close(self);
+            return 0;
+        }
+        self->data = data;
+        posix_madvise(self->data, self->size, POSIX_MADV_SEQUENTIAL);
+    }
+    return 1;
+}
+
+#endif  // __WINDOWS__
+
+#endif  // !_FILE_MAP_H_
@@ -0,0 +1,146 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "generator.h"
+
+#include <math.h>
+#include <string.h>
+
+#define GENERATOR_PI         3.14159265358979323846
+#define GENERATOR_AMPLITUDE  0.5  // -6 dBFS
+
+char const* const GENERATOR_LABELS[Generator_Count] =
+{
+    NULL,
+    "noise",
+    "sine",
+    "sweep",
+    "impulse"
+};
+
+// ============================================================================
+
+GeneratorKind Generator_Find(char const* label)
+{
+    for (int kind = Generator_None + 1; kind < Generator_Count; ++kind) {
+        if (!strcmp(label, GENERATOR_LABELS[kind])) {
+            return (GeneratorKind)kind;
+        }
+    }
+    return Generator_None;
+}
+
+// ----------------------------------------------------------------------------
+
+void Generator_Init(Generator* self, GeneratorKind kind, long channels, double rate, uint64_t frames)
+{
+    memset(self, 0, sizeof(*self));
+    self->kind = kind;
+    self->channels = channels;
+    self->frames = frames;
+    self->seed = 0x9E3779B97F4A7C15ull;
+
+    if (kind == Generator_Sine) {
+        double step = 2 * GENERATOR_PI * 1000 / rate;
+        self->phasor[0] = 1;
+        self->phasor[1] = 0;
+        self->rotation[0] = cos(step);
+        self->rotation[1] = sin(step);
+    }
+    else if (kind == Generator_Sweep) {
+        // Instantaneous frequency growing by a constant ratio per frame
+        double start = 20;
+        double stop = (rate * 0.45 < 20000 ? rate * 0.45 : 20000);
+        self->step = 2 * GENERATOR_PI * start / rate;
+        self->growth = (frames > 1 ? exp(log(stop / start) / (double)(frames - 1)) : 1);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+size_t Generator_Render(Generator* self, TDA8425_Float* samples, size_t count)
+{
+    uint64_t remaining = self->frames - self->frame;
+    size_t channels = (size_t)self->channels;
+
+    if ((uint64_t)count > remaining) {
+        count = (size_t)remaining;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        double value = 0;
+
+        if (self->kind == Generator_Noise) {
+            // Sum of uniform xorshift64* variates, with the sigma of gen_noise.py
+            for (size_t c = 0; c < channels; ++c) {
+                double sum = 0;
+                for (int k = 0; k < 4; ++k) {
+                    uint64_t x = self->seed;
+                    x ^= x >> 12;
+                    x ^= x << 25;
+                    x ^= x >> 27;
+                    self->seed = x;
+                    sum += (double)((x * 0x2545F4914F6CDD1Dull) >> 11) * (2.0 / 9007199254740992.0) - 1;
+                }
+                samples[i * channels + c] = (TDA8425_Float)(sum * (0.1 / 1.1547005383792515));  // sqrt(4/3)
+            }
+            continue;
+        }
+        if (self->kind == Generator_Impulse) {
+            value = (self->frame + i == 0 ? 1 : 0);
+        }
+        else if (self->kind == Generator_Sine) {
+            // Recursive oscillator, cheaper than sin()
+            double re = self->phasor[0];
+            double im = self->phasor[1];
+            value = GENERATOR_AMPLITUDE * im;
+            self->phasor[0] = re * self->rotation[0] - im * self->rotation[1];
+            self->phasor[1] = re * self->rotation[1] + im * self->rotation[0];
+        }
+        else if (self->kind == Generator_Sweep) {
+            value = GENERATOR_AMPLITUDE * sin(self->phase);
+            self->phase += self->step;
+            if (self->phase >= 2 * GENERATOR_PI) {
+                self->phase -= 2 * GENERATOR_PI;
+            }
+            self->step *= self->growth;
+        }
+
+        for (size_t c = 0; c < channels; ++c) {
+            samples[i * channels + c] = (TDA8425_Float)value;
+        }
+    }
+    // Keeps the phasor on the unit circle against rounding drift
+    double norm = sqrt(self->phasor[0] * self->phasor[0] + self->phasor[1] * self->phasor[1]);
+    if (norm > 0) {
+        self->phasor[0] /= norm;
+        self->phasor[1] /= norm;
+    }
+    self->frame += (uint64_t)count;
+    return count;
+}
@@ -0,0 +1,82 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Synthetic test signals, rendered in place of an input stream.
+
+#ifndef _GENERATOR_H_
+#define _GENERATOR_H_
+
+#include "TDA8425_emu.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum GeneratorKind {
+    Generator_None = 0,  //!< Not generating
+    Generator_Noise,     //!< Gaussian-like white noise, like gen_noise.py
+    Generator_Sine,      //!< 1 kHz sine at -6 dBFS
+    Generator_Sweep,     //!< Exponential sine sweep at -6 dBFS, 20 Hz to 20 kHz (or 45% rate)
+    Generator_Impulse,   //!< Unit impulse at the first frame, then silence
+    Generator_Count
+} GeneratorKind;
+
+typedef struct Generator {
+    GeneratorKind kind;  //!< Signal kind
+    long channels;       //!< Channels per frame; independent noise, else the same
+    uint64_t frames;     //!< Total frames
+    uint64_t frame;      //!< Frames rendered so far
+    uint64_t seed;       //!< Noise state
+    double phase;        //!< Sweep phase [rad]
+    double step;         //!< Sweep phase per frame [rad]
+    double growth;       //!< Sweep step ratio per frame
+    double phasor[2];    //!< Sine phasor, real and imaginary
+    double rotation[2];  //!< Sine phasor rotation per frame
+} Generator;
+
+//! Signal labels, indexed by GeneratorKind; NULL for Generator_None
+extern char const* const GENERATOR_LABELS[Generator_Count];
+
+//! Finds a signal kind by label; Generator_None if unknown
+GeneratorKind Generator_Find(char const* label);
+
+//! Prepares the rendering of the given number of frames
+void Generator_Init(Generator* self, GeneratorKind kind, long channels, double rate, uint64_t frames);
+
+//! Renders up to count interleaved frames; returns the frames rendered,
+//! fewer at the end
+size_t Generator_Render(Generator* self, TDA8425_Float* samples, size_t count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // !_GENERATOR_H_
@@ -1 +1,5 @@
-gcc -Wall -Wextra -Wno-overlength-strings -std=c99 -pedantic -I../src -Ofast -o TDA8425_pipe TDA8425_pipe.c ../src/TDA8425_emu.c -lm
+gcc -Wall -Wextra -Wno-overlength-strings -std=c99 -pedantic -I../src -Ofast -o TDA8425_pipe TDA8425_pipe.c events.c generator.c sample_format.c uring.c wave.c ../src/TDA8425_emu.c -lm -pthread
+gcc -Wall -Wextra -Wno-overlength-strings -std=c99 -pedantic -I../src -Ofast -o TDA8425_bench TDA8425_bench.c sample_format.c ../src/TDA8425_emu.c -lm
+gcc -Wall -Wextra -Wno-overlength-strings -std=c99 -pedantic -I../src -Ofast -DTDA8425_FLOAT=float -o TDA8425_bench_float TDA8425_bench.c sample_format.c ../src/TDA8425_emu.c -lm
+gcc -Wall -Wextra -Wno-overlength-strings -std=c99 -pedantic -I../src -Ofast -o TDA8425_check TDA8425_check.c events.c generator.c ../src/TDA8425_emu.c -lm
+gcc -Wall -Wextra -Wno-overlength-strings -std=c99 -pedantic -I../src -O3 -o TDA8425_latency TDA8425_latency.c generator.c ../src/TDA8425_emu.c -lm -pthread
@@ -0,0 +1,308 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L  // clock_gettime()
+#endif
+
+#include "sample_format.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "clock.h"
+#include "endian.h"
+
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+#define SWAP_LE  0
+#define SWAP_BE  1
+#elif __BYTE_ORDER == __BIG_ENDIAN
+#define SWAP_LE  1
+#define SWAP_BE  0
+#else
+#error "Unsupported __BYTE_ORDER"
+#endif
+
+// The converters are plain counted loops over whole buffers, without any
+// early exits or calls, so that optimizing compilers turn them into SIMD
+// code: scaling by multiplication, saturation by min/max, and byte swapping
+// by byte shuffles.
+
+// ============================================================================
+
+static inline uint8_t Swap8(uint8_t x)
+{
+    return x;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+
+static inline uint16_t Swap16(uint16_t x) { return __builtin_bswap16(x); }
+static inline uint32_t Swap32(uint32_t x) { return __builtin_bswap32(x); }
+static inline uint64_t Swap64(uint64_t x) { return __builtin_bswap64(x); }
+
+#else
+
+static inline uint16_t Swap16(uint16_t x)
+{
+    return (uint16_t)((x >> 8) | (x << 8));
+}
+
+static inline uint32_t Swap32(uint32_t x)
+{
+    return (((x >> 24) & 0x000000FFu) | ((x >>  8) & 0x0000FF00u) |
+            ((x <<  8) & 0x00FF0000u) | ((x << 24) & 0xFF000000u));
+}
+
+static inline uint64_t Swap64(uint64_t x)
+{
+    return (((uint64_t)Swap32((uint32_t)x) << 32) | (uint64_t)Swap32((uint32_t)(x >> 32)));
+}
+
+#endif  // __GNUC__
+
+// ----------------------------------------------------------------------------
+
+// Integer samples of BITS_ bits, stored right-aligned within a CONTAINER_ bit
+// word (as ALSA S24_LE), are decoded as signed, after flipping the sign bit of
+// the unsigned ones. Encoding saturates and truncates towards zero; any unused
+// bits are sign extended.
+#define DEFINE_INTEGER_CODEC(name_, bits_, container_, flip_, swap_)           \
+                                                                                \
+static void Decode##name_(TDA8425_Float* dst, void const* src, size_t count)    \
+{                                                                               \
+    uint8_t const* bytes = (uint8_t const*)src;                                 \
+    TDA8425_Float const scale = (TDA8425_Float)1 / -(TDA8425_Float)INT##container_##_MIN;  \
+                                                                                \
+    for (size_t i = 0; i < count; ++i) {                                        \
+        uint##container_##_t u;                                                 \
+        memcpy(&u, &bytes[i * sizeof(u)], sizeof(u));                           \
+        if (swap_) {                                                            \
+            u = Swap##container_(u);                                            \
+        }                                                                       \
+        u = (uint##container_##_t)(u << ((container_) - (bits_)));              \
+        u ^= (uint##container_##_t)(flip_);                                     \
+        dst[i] = (TDA8425_Float)(int##container_##_t)u * scale;                 \
+    }                                                                           \
+}                                                                               \
+                                                                                \
+static void Encode##name_(void* dst, TDA8425_Float const* src, size_t count)    \
+{                                                                               \
+    uint8_t* bytes = (uint8_t*)dst;                                             \
+    double const scale = (double)((int64_t)1 << ((bits_) - 1));                 \
+    double const lower = -scale;                                                \
+    double const upper = scale - 1;                                             \
+                                                                                \
+    for (size_t i = 0; i < count; ++i) {                                        \
+        double scaled = (double)src[i] * scale;                                 \
+        scaled = (scaled < lower) ? lower : scaled;                             \
+        scaled = (scaled > upper) ? upper : scaled;                             \
+        uint##container_##_t u = (uint##container_##_t)(int##container_##_t)scaled;  \
+        u ^= (uint##container_##_t)(flip_);                                     \
+        if (swap_) {                                                            \
+            u = Swap##container_(u);                                            \
+        }                                                                       \
+        memcpy(&bytes[i * sizeof(u)], &u, sizeof(u));                           \
+    }                                                                           \
+}
+
+// Packed 24-bit samples, as three bytes.
+#define DEFINE_PACKED24_CODEC(name_, b0_, b1_, b2_)                             \
+                                                                                \
+static void Decode##name_(TDA8425_Float* dst, void const* src, size_t count)    \
+{                                                                               \
+    uint8_t const* bytes = (uint8_t const*)src;                                 \
+    TDA8425_Float const scale = (TDA8425_Float)1 / -(TDA8425_Float)INT32_MIN;   \
+                                                                                \
+    for (size_t i = 0; i < count; ++i) {                                        \
+        uint8_t const* b = &bytes[i * 3];                                       \
+        uint32_t u = (((uint32_t)b[b0_] <<  8) |                                \
+                      ((uint32_t)b[b1_] << 16) |                                \
+                      ((uint32_t)b[b2_] << 24));                                \
+        dst[i] = (TDA8425_Float)(int32_t)u * scale;                             \
+    }                                                                           \
+}                                                                               \
+                                                                                \
+static void Encode##name_(void* dst, TDA8425_Float const* src, size_t count)    \
+{                                                                               \
+    uint8_t* bytes = (uint8_t*)dst;                                             \
+    double const scale = (double)((int32_t)1 << 23);                            \
+    double const lower = -scale;                                                \
+    double const upper = scale - 1;                                             \
+                                                                                \
+    for (size_t i = 0; i < count; ++i) {                                        \
+        double scaled = (double)src[i] * scale;                                 \
+        scaled = (scaled < lower) ? lower : scaled;                             \
+        scaled = (scaled > upper) ? upper : scaled;                             \
+        uint32_t u = (uint32_t)(int32_t)scaled;                                 \
+        uint8_t* b = &bytes[i * 3];                                             \
+        b[b0_] = (uint8_t)(u      );                                            \
+        b[b1_] = (uint8_t)(u >>  8);                                            \
+        b[b2_] = (uint8_t)(u >> 16);                                            \
+    }                                                                           \
+}
+
+#define DEFINE_FLOAT_CODEC(name_, type_, bits_, swap_)                          \
+                                                                                \
+static void Decode##name_(TDA8425_Float* dst, void const* src, size_t count)    \
+{                                                                               \
+    uint8_t const* bytes = (uint8_t const*)src;                                 \
+                                                                                \
+    for (size_t i = 0; i < count; ++i) {                                        \
+        uint##bits_##_t u;                                                      \
+        type_ f;                                                                \
+        memcpy(&u, &bytes[i * sizeof(u)], sizeof(u));                           \
+        if (swap_) {                                                            \
+            u = Swap##bits_(u);                                                 \
+        }                                                                       \
+        memcpy(&f, &u, sizeof(f));                                              \
+        dst[i] = (TDA8425_Float)f;                                              \
+    }                                                                           \
+}                                                                               \
+                                                                                \
+static void Encode##name_(void* dst, TDA8425_Float const* src, size_t count)    \
+{                                                                               \
+    uint8_t* bytes = (uint8_t*)dst;                                             \
+                                                                                \
+    for (size_t i = 0; i < count; ++i) {                                        \
+        type_ f = (type_)src[i];                                                \
+        uint##bits_##_t u;                                                      \
+        memcpy(&u, &f, sizeof(u));                                              \
+        if (swap_) {                                                            \
+            u = Swap##bits_(u);                                                 \
+        }                                                                       \
+        memcpy(&bytes[i * sizeof(u)], &u, sizeof(u));                           \
+    }                                                                           \
+}
+
+// ============================================================================
+
+DEFINE_INTEGER_CODEC(U8,    8,  8, 0x80u,       0)
+DEFINE_INTEGER_CODEC(S8,    8,  8, 0,           0)
+DEFINE_INTEGER_CODEC(U16L, 16, 16, 0x8000u,     SWAP_LE)
+DEFINE_INTEGER_CODEC(U16B, 16, 16, 0x8000u,     SWAP_BE)
+DEFINE_INTEGER_CODEC(S16L, 16, 16, 0,           SWAP_LE)
+DEFINE_INTEGER_CODEC(S16B, 16, 16, 0,           SWAP_BE)
+DEFINE_INTEGER_CODEC(S24L, 24, 32, 0,           SWAP_LE)
+DEFINE_INTEGER_CODEC(S24B, 24, 32, 0,           SWAP_BE)
+DEFINE_INTEGER_CODEC(U32L, 32, 32, 0x80000000u, SWAP_LE)
+DEFINE_INTEGER_CODEC(U32B, 32, 32, 0x80000000u, SWAP_BE)
+DEFINE_INTEGER_CODEC(S32L, 32, 32, 0,           SWAP_LE)
+DEFINE_INTEGER_CODEC(S32B, 32, 32, 0,           SWAP_BE)
+
+DEFINE_PACKED24_CODEC(S24_3L, 0, 1, 2)
+DEFINE_PACKED24_CODEC(S24_3B, 2, 1, 0)
+
+DEFINE_FLOAT_CODEC(F32L, float,  32, SWAP_LE)
+DEFINE_FLOAT_CODEC(F32B, float,  32, SWAP_BE)
+DEFINE_FLOAT_CODEC(F64L, double, 64, SWAP_LE)
+DEFINE_FLOAT_CODEC(F64B, double, 64, SWAP_BE)
+
+// ----------------------------------------------------------------------------
+
+SampleFormat const SAMPLE_FORMAT_TABLE[] =
+{
+    { "U8",         1, DecodeU8,     EncodeU8     },
+    { "S8",         1, DecodeS8,     EncodeS8     },
+    { "U16_LE",     2, DecodeU16L,   EncodeU16L   },
+    { "U16_BE",     2, DecodeU16B,   EncodeU16B   },
+    { "S16_LE",     2, DecodeS16L,   EncodeS16L   },
+    { "S16_BE",     2, DecodeS16B,   EncodeS16B   },
+    { "S24_LE",     4, DecodeS24L,   EncodeS24L   },
+    { "S24_BE",     4, DecodeS24B,   EncodeS24B   },
+    { "S24_3LE",    3, DecodeS24_3L, EncodeS24_3L },
+    { "S24_3BE",    3, DecodeS24_3B, EncodeS24_3B },
+    { "U32_LE",     4, DecodeU32L,   EncodeU32L   },
+    { "U32_BE",     4, DecodeU32B,   EncodeU32B   },
+    { "S32_LE",     4, DecodeS32L,   EncodeS32L   },
+    { "S32_BE",     4, DecodeS32B,   EncodeS32B   },
+    { "FLOAT_LE",   4, DecodeF32L,   EncodeF32L   },
+    { "FLOAT_BE",   4, DecodeF32B,   EncodeF32B   },
+    { "FLOAT64_LE", 8, DecodeF64L,   EncodeF64L   },
+    { "FLOAT64_BE", 8, DecodeF64B,   EncodeF64B   },
+    { NULL,         0, NULL,         NULL         }
+};
+
+// ----------------------------------------------------------------------------
+
+SampleFormat const* SampleFormat_Find(char const* label)
+{
+    for (SampleFormat const* format = SAMPLE_FORMAT_TABLE; format->label; ++format) {
+        if (!strcmp(label, format->label)) {
+            return format;
+        }
+    }
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+
+int SampleFormat_Measure(SampleFormat const* format, size_t count, double min_time,
+                         double* decode_speed, double* encode_speed)
+{
+    TDA8425_Float* samples = (TDA8425_Float*)malloc(count * sizeof(TDA8425_Float));
+    TDA8425_Float* decoded = (TDA8425_Float*)malloc(count * sizeof(TDA8425_Float));
+    void* buffer = malloc(count * format->size);
+    double bytes = (double)count * (double)format->size;
+    double speed[2] = { 0, 0 };
+    int ok = (samples && decoded && buffer);
+
+    if (ok) {
+        for (size_t i = 0; i < count; ++i) {
+            samples[i] = (TDA8425_Float)(1.25 * sin((double)i * 0.001));  // some clipping
+        }
+
+        // Encode first, so that decoding reads valid data
+        for (int pass = 1; pass >= 0; --pass) {
+            long rounds = 0;
+            double start = Clock_Seconds();
+            double elapsed;
+            do {
+                for (int k = 0; k < 16; ++k) {
+                    if (pass) {
+                        format->encoder(buffer, samples, count);
+                    }
+                    else {
+                        format->decoder(decoded, buffer, count);
+                    }
+                }
+                rounds += 16;
+                elapsed = Clock_Seconds() - start;
+            } while (elapsed < min_time);
+            speed[pass] = bytes * (double)rounds / elapsed;
+        }
+    }
+
+    *decode_speed = speed[0];
+    *encode_speed = speed[1];
+    free(buffer);
+    free(decoded);
+    free(samples);
+    return ok;
+}
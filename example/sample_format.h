@@ -0,0 +1,67 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Block conversion between stream sample formats and TDA8425_Float.
+
+#ifndef _SAMPLE_FORMAT_H_
+#define _SAMPLE_FORMAT_H_
+
+#include "TDA8425_emu.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*SampleFormat_Decoder)(TDA8425_Float* dst, void const* src, size_t count);
+typedef void (*SampleFormat_Encoder)(void* dst, TDA8425_Float const* src, size_t count);
+
+typedef struct SampleFormat {
+    char const* label;             //!< Format name, as per ALSA
+    size_t size;                   //!< Bytes per sample
+    SampleFormat_Decoder decoder;  //!< Converts a whole buffer to TDA8425_Float
+    SampleFormat_Encoder encoder;  //!< Converts a whole buffer from TDA8425_Float
+} SampleFormat;
+
+//! Supported formats, terminated by a NULL label
+extern SampleFormat const SAMPLE_FORMAT_TABLE[];
+
+//! Finds a format by name; NULL if unknown
+SampleFormat const* SampleFormat_Find(char const* label);
+
+//! Measures the decoding and encoding speed of a format [B/s of stream data],
+//! over count samples, for at least min_time seconds each; returns 0 on errors
+int SampleFormat_Measure(SampleFormat const* format, size_t count, double min_time,
+                         double* decode_speed, double* encode_speed);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // !_SAMPLE_FORMAT_H_
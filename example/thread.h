@@ -0,0 +1,177 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Minimal portable threading for the examples.
+
+#ifndef _THREAD_H_
+#define _THREAD_H_
+
+#if (defined(_WIN16) || defined(_WIN32) || defined(_WIN64)) && !defined(__WINDOWS__)
+#define __WINDOWS__
+#endif
+
+#ifdef __WINDOWS__
+
+#include <windows.h>
+
+typedef HANDLE Thread;
+
+#define THREAD_ROUTINE(name_, arg_)  DWORD WINAPI name_(LPVOID arg_)
+#define THREAD_RETURN                return 0
+
+static inline int Thread_Start(Thread* thread, LPTHREAD_START_ROUTINE routine, void* arg)
+{
+    *thread = CreateThread(NULL, 0, routine, arg, 0, NULL);
+    return *thread != NULL;
+}
+
+static inline void Thread_Join(Thread* thread)
+{
+    WaitForSingleObject(*thread, INFINITE);
+    CloseHandle(*thread);
+}
+
+static inline void Thread_Yield(void)
+{
+    SwitchToThread();
+}
+
+static inline void Thread_Sleep(unsigned microseconds)
+{
+    Sleep((microseconds + 999) / 1000);
+}
+
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE Condition;
+
+static inline void Mutex_Init(Mutex* mutex)     { InitializeCriticalSection(mutex); }
+static inline void Mutex_Destroy(Mutex* mutex)  { DeleteCriticalSection(mutex); }
+static inline void Mutex_Lock(Mutex* mutex)     { EnterCriticalSection(mutex); }
+static inline void Mutex_Unlock(Mutex* mutex)   { LeaveCriticalSection(mutex); }
+
+static inline void Condition_Init(Condition* cond)       { InitializeConditionVariable(cond); }
+static inline void Condition_Destroy(Condition* cond)    { (void)cond; }
+static inline void Condition_Signal(Condition* cond)     { WakeConditionVariable(cond); }
+static inline void Condition_Broadcast(Condition* cond)  { WakeAllConditionVariable(cond); }
+
+static inline void Condition_Wait(Condition* cond, Mutex* mutex)
+{
+    SleepConditionVariableCS(cond, mutex, INFINITE);
+}
+
+//! Load with acquire semantics
+static inline unsigned long Atomic_Load(unsigned long volatile* ptr)
+{
+    return (unsigned long)InterlockedCompareExchange((LONG volatile*)ptr, 0, 0);
+}
+
+//! Store with release semantics
+static inline void Atomic_Store(unsigned long volatile* ptr, unsigned long value)
+{
+    InterlockedExchange((LONG volatile*)ptr, (LONG)value);
+}
+
+//! Adds a value, returning the previous one
+static inline unsigned long Atomic_FetchAdd(unsigned long volatile* ptr, unsigned long value)
+{
+    return (unsigned long)InterlockedExchangeAdd((LONG volatile*)ptr, (LONG)value);
+}
+
+#else  // POSIX
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+typedef pthread_t Thread;
+
+#define THREAD_ROUTINE(name_, arg_)  void* name_(void* arg_)
+#define THREAD_RETURN                return NULL
+
+static inline int Thread_Start(Thread* thread, void* (*routine)(void*), void* arg)
+{
+    return !pthread_create(thread, NULL, routine, arg);
+}
+
+static inline void Thread_Join(Thread* thread)
+{
+    pthread_join(*thread, NULL);
+}
+
+static inline void Thread_Yield(void)
+{
+    sched_yield();
+}
+
+static inline void Thread_Sleep(unsigned microseconds)
+{
+    struct timespec delay;
+    delay.tv_sec = (time_t)(microseconds / 1000000u);
+    delay.tv_nsec = (long)(microseconds % 1000000u) * 1000L;
+    nanosleep(&delay, NULL);
+}
+
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Condition;
+
+static inline void Mutex_Init(Mutex* mutex)     { pthread_mutex_init(mutex, NULL); }
+static inline void Mutex_Destroy(Mutex* mutex)  { pthread_mutex_destroy(mutex); }
+static inline void Mutex_Lock(Mutex* mutex)     { pthread_mutex_lock(mutex); }
+static inline void Mutex_Unlock(Mutex* mutex)   { pthread_mutex_unlock(mutex); }
+
+static inline void Condition_Init(Condition* cond)       { pthread_cond_init(cond, NULL); }
+static inline void Condition_Destroy(Condition* cond)    { pthread_cond_destroy(cond); }
+static inline void Condition_Signal(Condition* cond)     { pthread_cond_signal(cond); }
+static inline void Condition_Broadcast(Condition* cond)  { pthread_cond_broadcast(cond); }
+
+static inline void Condition_Wait(Condition* cond, Mutex* mutex)
+{
+    pthread_cond_wait(cond, mutex);
+}
+
+//! Load with acquire semantics
+static inline unsigned long Atomic_Load(unsigned long volatile* ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+//! Store with release semantics
+static inline void Atomic_Store(unsigned long volatile* ptr, unsigned long value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+//! Adds a value, returning the previous one
+static inline unsigned long Atomic_FetchAdd(unsigned long volatile* ptr, unsigned long value)
+{
+    return __atomic_fetch_add(ptr, value, __ATOMIC_ACQ_REL);
+}
+
+#endif  // __WINDOWS__
+
+#endif  // !_THREAD_H_
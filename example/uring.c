@@ -0,0 +1,295 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE  // syscall()
+#endif
+
+#include "uring.h"
+
+#include <errno.h>
+#include <string.h>
+
+#if URING_SUPPORTED
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define URING_MAX_BUFFERS 64
+
+// Shared ring indices, as per the kernel memory model
+#define URING_LOAD_ACQUIRE(ptr_)          __atomic_load_n((ptr_), __ATOMIC_ACQUIRE)
+#define URING_STORE_RELEASE(ptr_, value_) __atomic_store_n((ptr_), (value_), __ATOMIC_RELEASE)
+
+// ============================================================================
+
+int Uring_Init(Uring* self, unsigned entries)
+{
+    struct io_uring_params params;
+
+    memset(self, 0, sizeof(*self));
+    memset(&params, 0, sizeof(params));
+    self->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (self->fd < 0) {
+        self->fd = -1;
+        return 0;
+    }
+
+    self->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    self->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    self->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    self->sq_ring = mmap(NULL, self->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         self->fd, (off_t)IORING_OFF_SQ_RING);
+    self->cq_ring = mmap(NULL, self->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         self->fd, (off_t)IORING_OFF_CQ_RING);
+    self->sqes = mmap(NULL, self->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      self->fd, (off_t)IORING_OFF_SQES);
+    if (self->sq_ring == MAP_FAILED || self->cq_ring == MAP_FAILED || self->sqes == MAP_FAILED) {
+        int error = errno;
+        Uring_Exit(self);
+        errno = error;
+        return 0;
+    }
+
+    unsigned char* sq = (unsigned char*)self->sq_ring;
+    self->sq_head = (unsigned*)(sq + params.sq_off.head);
+    self->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    self->sq_array = (unsigned*)(sq + params.sq_off.array);
+    self->sq_mask = *(unsigned*)(sq + params.sq_off.ring_mask);
+    self->sq_entries = params.sq_entries;
+
+    unsigned char* cq = (unsigned char*)self->cq_ring;
+    self->cq_head = (unsigned*)(cq + params.cq_off.head);
+    self->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    self->cq_mask = *(unsigned*)(cq + params.cq_off.ring_mask);
+    self->cqes = cq + params.cq_off.cqes;
+    return 1;
+}
+
+// ----------------------------------------------------------------------------
+
+void Uring_Exit(Uring* self)
+{
+    if (self->sqes && self->sqes != MAP_FAILED) {
+        munmap(self->sqes, self->sqes_size);
+    }
+    if (self->cq_ring && self->cq_ring != MAP_FAILED) {
+        munmap(self->cq_ring, self->cq_ring_size);
+    }
+    if (self->sq_ring && self->sq_ring != MAP_FAILED) {
+        munmap(self->sq_ring, self->sq_ring_size);
+    }
+    if (self->fd >= 0) {
+        close(self->fd);
+    }
+    memset(self, 0, sizeof(*self));
+    self->fd = -1;
+}
+
+// ----------------------------------------------------------------------------
+
+int Uring_RegisterBuffers(Uring* self, UringBuffer const* buffers, unsigned count)
+{
+    struct iovec iovecs[URING_MAX_BUFFERS];
+
+    if (count > URING_MAX_BUFFERS) {
+        errno = EINVAL;
+        return 0;
+    }
+    for (unsigned i = 0; i < count; ++i) {
+        iovecs[i].iov_base = buffers[i].data;
+        iovecs[i].iov_len = buffers[i].size;
+    }
+    return syscall(__NR_io_uring_register, self->fd, IORING_REGISTER_BUFFERS, iovecs, count) >= 0;
+}
+
+// ----------------------------------------------------------------------------
+
+static int Uring_Queue(Uring* self, int opcode, int fd, void const* data, unsigned size, uint64_t offset,
+                       unsigned buffer_index, uint64_t user_data)
+{
+    unsigned tail = *self->sq_tail;  // only written by us
+
+    if (tail - URING_LOAD_ACQUIRE(self->sq_head) >= self->sq_entries) {
+        return 0;
+    }
+    unsigned index = tail & self->sq_mask;
+    struct io_uring_sqe* sqe = &((struct io_uring_sqe*)self->sqes)[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = (uint8_t)opcode;
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->addr = (uint64_t)(uintptr_t)data;
+    sqe->len = size;
+    sqe->buf_index = (uint16_t)buffer_index;
+    sqe->user_data = user_data;
+
+    self->sq_array[index] = index;
+    URING_STORE_RELEASE(self->sq_tail, tail + 1);
+    ++self->queued;
+    return 1;
+}
+
+// ----------------------------------------------------------------------------
+
+int Uring_QueueRead(Uring* self, int fd, void* data, unsigned size, uint64_t offset,
+                    unsigned buffer_index, uint64_t user_data)
+{
+    return Uring_Queue(self, IORING_OP_READ_FIXED, fd, data, size, offset, buffer_index, user_data);
+}
+
+// ----------------------------------------------------------------------------
+
+int Uring_QueueWrite(Uring* self, int fd, void const* data, unsigned size, uint64_t offset,
+                     unsigned buffer_index, uint64_t user_data)
+{
+    return Uring_Queue(self, IORING_OP_WRITE_FIXED, fd, data, size, offset, buffer_index, user_data);
+}
+
+// ----------------------------------------------------------------------------
+
+int Uring_Submit(Uring* self, unsigned wait)
+{
+    while (self->queued || wait) {
+        unsigned flags = (wait ? IORING_ENTER_GETEVENTS : 0u);
+        long result = syscall(__NR_io_uring_enter, self->fd, self->queued, wait, flags, NULL, 0);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+        self->queued -= (unsigned)result;
+        wait = 0;
+    }
+    return 1;
+}
+
+// ----------------------------------------------------------------------------
+
+int Uring_Reap(Uring* self, uint64_t* user_data, int* result)
+{
+    unsigned head = *self->cq_head;  // only written by us
+
+    if (head == URING_LOAD_ACQUIRE(self->cq_tail)) {
+        return 0;
+    }
+    struct io_uring_cqe const* cqe = &((struct io_uring_cqe const*)self->cqes)[head & self->cq_mask];
+    *user_data = cqe->user_data;
+    *result = cqe->res;
+    URING_STORE_RELEASE(self->cq_head, head + 1);
+    return 1;
+}
+
+#else  // !URING_SUPPORTED
+
+// ============================================================================
+
+int Uring_Init(Uring* self, unsigned entries)
+{
+    (void)entries;
+    memset(self, 0, sizeof(*self));
+    self->fd = -1;
+    errno = ENOSYS;
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+void Uring_Exit(Uring* self)
+{
+    self->fd = -1;
+}
+
+// ----------------------------------------------------------------------------
+
+int Uring_RegisterBuffers(Uring* self, UringBuffer const* buffers, unsigned count)
+{
+    (void)self;
+    (void)buffers;
+    (void)count;
+    errno = ENOSYS;
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+int Uring_QueueRead(Uring* self, int fd, void* data, unsigned size, uint64_t offset,
+                    unsigned buffer_index, uint64_t user_data)
+{
+    (void)self;
+    (void)fd;
+    (void)data;
+    (void)size;
+    (void)offset;
+    (void)buffer_index;
+    (void)user_data;
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+int Uring_QueueWrite(Uring* self, int fd, void const* data, unsigned size, uint64_t offset,
+                     unsigned buffer_index, uint64_t user_data)
+{
+    (void)self;
+    (void)fd;
+    (void)data;
+    (void)size;
+    (void)offset;
+    (void)buffer_index;
+    (void)user_data;
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+int Uring_Submit(Uring* self, unsigned wait)
+{
+    (void)self;
+    (void)wait;
+    errno = ENOSYS;
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+int Uring_Reap(Uring* self, uint64_t* user_data, int* result)
+{
+    (void)self;
+    (void)user_data;
+    (void)result;
+    return 0;
+}
+
+#endif  // URING_SUPPORTED
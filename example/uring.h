@@ -0,0 +1,111 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Minimal io_uring queue over raw system calls, for the examples.
+// Available only under Linux; elsewhere, Uring_Init() always fails.
+
+#ifndef _URING_H_
+#define _URING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef URING_SUPPORTED
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define URING_SUPPORTED 1
+#endif
+#endif
+#endif
+#ifndef URING_SUPPORTED
+#define URING_SUPPORTED 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define URING_STREAM_OFFSET  UINT64_MAX  //!< Current position, for pipes
+
+typedef struct Uring {
+    int fd;               //!< Ring file descriptor, or -1
+    void* sq_ring;        //!< Submission ring mapping
+    size_t sq_ring_size;
+    void* cq_ring;        //!< Completion ring mapping
+    size_t cq_ring_size;
+    void* sqes;           //!< Submission entries mapping
+    size_t sqes_size;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_array;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    void* cqes;
+    unsigned queued;      //!< Entries not submitted yet
+} Uring;
+
+typedef struct UringBuffer {
+    void* data;   //!< Buffer address
+    size_t size;  //!< Buffer size [B]
+} UringBuffer;
+
+//! Sets up a ring with the given number of submission entries.
+//! Returns 0 with errno set if io_uring is not available.
+int Uring_Init(Uring* self, unsigned entries);
+
+//! Tears down the ring; all the requests must have completed
+void Uring_Exit(Uring* self);
+
+//! Registers fixed buffers, referenced by index; returns 0 with errno set
+int Uring_RegisterBuffers(Uring* self, UringBuffer const* buffers, unsigned count);
+
+//! Queues a read into a registered buffer, at a file offset or
+//! URING_STREAM_OFFSET; returns 0 if the submission ring is full
+int Uring_QueueRead(Uring* self, int fd, void* data, unsigned size, uint64_t offset,
+                    unsigned buffer_index, uint64_t user_data);
+
+//! Queues a write from a registered buffer, like Uring_QueueRead()
+int Uring_QueueWrite(Uring* self, int fd, void const* data, unsigned size, uint64_t offset,
+                     unsigned buffer_index, uint64_t user_data);
+
+//! Submits the queued requests, and waits for at least the given number of
+//! completions; returns 0 with errno set on errors
+int Uring_Submit(Uring* self, unsigned wait);
+
+//! Pops a completion, if any: its user data, and its result as per
+//! read()/write(), or -errno; returns 0 if none
+int Uring_Reap(Uring* self, uint64_t* user_data, int* result);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // !_URING_H_
@@ -0,0 +1,296 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "wave.h"
+
+#include <string.h>
+
+// All the fields are little-endian.
+
+enum {
+    WAVE_FORMAT_PCM        = 0x0001,
+    WAVE_FORMAT_IEEE_FLOAT = 0x0003,
+    WAVE_FORMAT_EXTENSIBLE = 0xFFFE
+};
+
+// KSDATAFORMAT_SUBTYPE_* GUID, after the format tag
+static uint8_t const WAVE_SUBTYPE_TAIL[14] = {
+    0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+};
+
+// Formats as stored in WAV files; samples with fewer valid bits than their
+// container are left-aligned, so they decode as the whole container
+static struct WaveFormatTable {
+    char const* label;
+    unsigned tag;
+    unsigned bits;        // container
+    unsigned valid_bits;
+} const WAVE_FORMAT_TABLE[] =
+{
+    { "U8",         WAVE_FORMAT_PCM,         8,  8 },
+    { "S16_LE",     WAVE_FORMAT_PCM,        16, 16 },
+    { "S24_3LE",    WAVE_FORMAT_PCM,        24, 24 },
+    { "S32_LE",     WAVE_FORMAT_PCM,        32, 32 },
+    { "FLOAT_LE",   WAVE_FORMAT_IEEE_FLOAT, 32, 32 },
+    { "FLOAT64_LE", WAVE_FORMAT_IEEE_FLOAT, 64, 64 },
+    { NULL,         0,                       0,  0 }
+};
+
+// ============================================================================
+
+static unsigned Get16(uint8_t const* p)
+{
+    return (unsigned)p[0] | ((unsigned)p[1] << 8);
+}
+
+static uint32_t Get32(uint8_t const* p)
+{
+    return (uint32_t)Get16(p) | ((uint32_t)Get16(p + 2) << 16);
+}
+
+static uint64_t Get64(uint8_t const* p)
+{
+    return (uint64_t)Get32(p) | ((uint64_t)Get32(p + 4) << 32);
+}
+
+static uint8_t* Put16(uint8_t* p, unsigned x)
+{
+    p[0] = (uint8_t)x;
+    p[1] = (uint8_t)(x >> 8);
+    return p + 2;
+}
+
+static uint8_t* Put32(uint8_t* p, uint32_t x)
+{
+    p = Put16(p, (unsigned)(x & 0xFFFFu));
+    return Put16(p, (unsigned)(x >> 16));
+}
+
+static uint8_t* Put64(uint8_t* p, uint64_t x)
+{
+    p = Put32(p, (uint32_t)x);
+    return Put32(p, (uint32_t)(x >> 32));
+}
+
+static uint8_t* PutId(uint8_t* p, char const* id)
+{
+    memcpy(p, id, 4);
+    return p + 4;
+}
+
+// ----------------------------------------------------------------------------
+
+int Wave_Detect(void const* peek, size_t size)
+{
+    uint8_t const* p = (uint8_t const*)peek;
+
+    return (size >= WAVE_PEEK_SIZE &&
+            (!memcmp(p, "RIFF", 4) || !memcmp(p, "RF64", 4) || !memcmp(p, "BW64", 4)) &&
+            !memcmp(&p[8], "WAVE", 4));
+}
+
+// ----------------------------------------------------------------------------
+
+static int Wave_ReadExactly(Wave_Reader reader, void* context, void* buffer, long size)
+{
+    return reader(context, buffer, size) == size;
+}
+
+static int Wave_Skip(Wave_Reader reader, void* context, uint64_t size)
+{
+    uint8_t scratch[256];
+
+    while (size) {
+        long chunk = (long)(size < sizeof(scratch) ? size : sizeof(scratch));
+        if (!Wave_ReadExactly(reader, context, scratch, chunk)) {
+            return 0;
+        }
+        size -= (uint64_t)chunk;
+    }
+    return 1;
+}
+
+char const* Wave_ReadHeader(WaveInfo* info, void const* peek, Wave_Reader reader, void* context)
+{
+    uint8_t const* riff = (uint8_t const*)peek;
+    int rf64 = memcmp(riff, "RIFF", 4);
+    uint64_t ds64_data_size = WAVE_UNKNOWN_SIZE;
+    uint8_t fmt[40];
+    int fmt_found = 0;
+
+    for (;;) {
+        uint8_t chunk[8];
+        if (!Wave_ReadExactly(reader, context, chunk, sizeof(chunk))) {
+            return "WAV data chunk not found";
+        }
+        uint32_t size = Get32(&chunk[4]);
+
+        if (!memcmp(chunk, "data", 4)) {
+            if (!fmt_found) {
+                return "WAV fmt chunk not found before data";
+            }
+            if (rf64 && size == 0xFFFFFFFFu) {
+                info->data_size = ds64_data_size;
+            }
+            else if (size == 0xFFFFFFFFu || !size) {
+                info->data_size = WAVE_UNKNOWN_SIZE;  // streamed
+            }
+            else {
+                info->data_size = size;
+            }
+            break;
+        }
+        else if (!memcmp(chunk, "fmt ", 4) || !memcmp(chunk, "ds64", 4)) {
+            uint8_t* payload = fmt;
+            uint8_t ds64[24];
+            long kept = (long)(size < sizeof(fmt) ? size : sizeof(fmt));
+
+            if (!memcmp(chunk, "ds64", 4)) {
+                if (size < sizeof(ds64)) {
+                    return "Invalid RF64 ds64 chunk";
+                }
+                payload = ds64;
+                kept = (long)sizeof(ds64);
+            }
+            else {
+                if (size < 16) {
+                    return "Invalid WAV fmt chunk";
+                }
+                memset(fmt, 0, sizeof(fmt));
+                fmt_found = 1;
+            }
+            if (!Wave_ReadExactly(reader, context, payload, kept) ||
+                !Wave_Skip(reader, context, (uint64_t)(size - (uint32_t)kept) + (size & 1))) {
+                return "Truncated WAV header";
+            }
+            if (payload == ds64) {
+                ds64_data_size = Get64(&ds64[8]);
+            }
+        }
+        else if (!Wave_Skip(reader, context, (uint64_t)size + (size & 1))) {
+            return "Truncated WAV header";
+        }
+    }
+
+    unsigned tag = Get16(&fmt[0]);
+    unsigned bits = Get16(&fmt[14]);
+    unsigned valid_bits = bits;
+    if (tag == WAVE_FORMAT_EXTENSIBLE) {
+        if (Get16(&fmt[16]) < 22 || memcmp(&fmt[26], WAVE_SUBTYPE_TAIL, sizeof(WAVE_SUBTYPE_TAIL))) {
+            return "Unsupported WAVE_FORMAT_EXTENSIBLE subtype";
+        }
+        valid_bits = Get16(&fmt[18]);
+        tag = Get16(&fmt[24]);
+    }
+
+    info->format = NULL;
+    for (int i = 0; WAVE_FORMAT_TABLE[i].label; ++i) {
+        if (WAVE_FORMAT_TABLE[i].tag == tag &&
+            WAVE_FORMAT_TABLE[i].bits == bits &&
+            WAVE_FORMAT_TABLE[i].valid_bits >= valid_bits) {
+            info->format = SampleFormat_Find(WAVE_FORMAT_TABLE[i].label);
+            break;
+        }
+    }
+    if (!info->format) {
+        return "Unsupported WAV sample format";
+    }
+
+    info->channels = (long)Get16(&fmt[2]);
+    info->rate = (unsigned long)Get32(&fmt[4]);
+    if (!info->channels || !info->rate ||
+        Get16(&fmt[12]) != (unsigned)info->channels * (unsigned)info->format->size) {
+        return "Invalid WAV fmt chunk";
+    }
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+
+size_t Wave_FormatHeader(uint8_t header[WAVE_MAX_HEADER_SIZE], WaveInfo const* info)
+{
+    struct WaveFormatTable const* entry;
+    for (entry = WAVE_FORMAT_TABLE; entry->label; ++entry) {
+        if (!strcmp(entry->label, info->format->label)) {
+            break;
+        }
+    }
+    if (!entry->label) {
+        return 0;
+    }
+
+    int extensible = (entry->tag == WAVE_FORMAT_PCM && entry->bits > 16);
+    uint32_t fmt_size = (extensible ? 40 : (entry->tag == WAVE_FORMAT_PCM ? 16 : 18));
+    uint32_t header_size = 12 + 36 + 8 + fmt_size + 8;
+    unsigned block_align = (unsigned)info->channels * entry->bits / 8;
+    uint64_t riff_size = WAVE_UNKNOWN_SIZE;
+    int rf64 = 0;
+
+    if (info->data_size != WAVE_UNKNOWN_SIZE) {
+        riff_size = (header_size - 8) + info->data_size + (info->data_size & 1);
+        rf64 = (riff_size > 0xFFFFFFFEu);
+    }
+
+    // The JUNK chunk reserves room for a ds64 chunk, to switch to RF64 when
+    // back-patching
+    uint8_t* p = header;
+    p = PutId(p, rf64 ? "RF64" : "RIFF");
+    p = Put32(p, (rf64 || riff_size == WAVE_UNKNOWN_SIZE) ? 0xFFFFFFFFu : (uint32_t)riff_size);
+    p = PutId(p, "WAVE");
+
+    p = PutId(p, rf64 ? "ds64" : "JUNK");
+    p = Put32(p, 28);
+    p = Put64(p, rf64 ? riff_size : 0);
+    p = Put64(p, rf64 ? info->data_size : 0);
+    p = Put64(p, rf64 ? info->data_size / block_align : 0);
+    p = Put32(p, 0);
+
+    p = PutId(p, "fmt ");
+    p = Put32(p, fmt_size);
+    p = Put16(p, extensible ? WAVE_FORMAT_EXTENSIBLE : entry->tag);
+    p = Put16(p, (unsigned)info->channels);
+    p = Put32(p, (uint32_t)info->rate);
+    p = Put32(p, (uint32_t)(info->rate * block_align));
+    p = Put16(p, block_align);
+    p = Put16(p, entry->bits);
+    if (fmt_size > 16) {
+        p = Put16(p, fmt_size - 18);
+    }
+    if (extensible) {
+        p = Put16(p, entry->valid_bits);
+        p = Put32(p, (info->channels == 2) ? 0x3u : 0);  // front left + right
+        p = Put16(p, entry->tag);
+        memcpy(p, WAVE_SUBTYPE_TAIL, sizeof(WAVE_SUBTYPE_TAIL));
+        p += sizeof(WAVE_SUBTYPE_TAIL);
+    }
+
+    p = PutId(p, "data");
+    p = Put32(p, (rf64 || info->data_size == WAVE_UNKNOWN_SIZE) ? 0xFFFFFFFFu : (uint32_t)info->data_size);
+
+    return (size_t)(p - header);
+}
@@ -0,0 +1,75 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Streaming WAV, WAVE_FORMAT_EXTENSIBLE and RF64 (BW64) headers.
+
+#ifndef _WAVE_H_
+#define _WAVE_H_
+
+#include "sample_format.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WAVE_UNKNOWN_SIZE  UINT64_MAX  //!< Streamed data, up to the end
+
+enum {
+    WAVE_PEEK_SIZE       = 12,              //!< RIFF/RF64 header, for detection
+    WAVE_MAX_HEADER_SIZE = 12 + 36 + 48 + 8 //!< RIFF + JUNK/ds64 + fmt + data
+};
+
+typedef struct WaveInfo {
+    SampleFormat const* format;  //!< Sample format
+    long channels;               //!< Channels per frame
+    unsigned long rate;          //!< Sample rate [Hz]
+    uint64_t data_size;          //!< Data chunk size [B], or WAVE_UNKNOWN_SIZE
+} WaveInfo;
+
+//! Reads up to size bytes; returns the bytes read (fewer at the end), or -1
+typedef long (*Wave_Reader)(void* context, void* buffer, long size);
+
+//! Checks whether the first WAVE_PEEK_SIZE bytes start a WAV file
+int Wave_Detect(void const* peek, size_t size);
+
+//! Reads the chunks following the peeked bytes, up to the data chunk payload.
+//! Returns NULL on success, or an error message.
+char const* Wave_ReadHeader(WaveInfo* info, void const* peek, Wave_Reader reader, void* context);
+
+//! Formats a header of constant size for the format, with final sizes if
+//! known. Returns the header size, or 0 if the format is not supported.
+size_t Wave_FormatHeader(uint8_t header[WAVE_MAX_HEADER_SIZE], WaveInfo const* info);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // !_WAVE_H_
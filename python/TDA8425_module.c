@@ -0,0 +1,469 @@
+/*
+BSD 2-Clause License
+
+Copyright (c) 2020-2024, Andrea Zoppi
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// CPython extension, processing buffer protocol objects (bytearray, array,
+// numpy arrays, ...) in place, without copies.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "TDA8425_emu.h"
+
+#include <string.h>
+
+#define FRAME_FIELDS  ((Py_ssize_t)(sizeof(TDA8425_Chip_Process_Data) / sizeof(TDA8425_Float)))
+
+// ============================================================================
+
+typedef struct ChipObject {
+    PyObject_HEAD
+    TDA8425_Chip* chip;
+    int busy;            // processing without the GIL
+} ChipObject;
+
+
+// Gets a C-contiguous buffer of TDA8425_Float; returns 0 with an exception set
+static int GetFloatBuffer(PyObject* obj, Py_buffer* view, int writable, char const* name)
+{
+    // Frames are interleaved rows, so Fortran-ordered arrays are refused
+    int flags = PyBUF_FORMAT | PyBUF_C_CONTIGUOUS | (writable ? PyBUF_WRITABLE : 0);
+    char const* format;
+
+    if (PyObject_GetBuffer(obj, view, flags) < 0) {
+        return 0;
+    }
+    format = view->format ? view->format : "B";
+    if (*format == '@' || *format == '=' || *format == '<') {
+        ++format;  // native or little-endian, as per x86 and ARM
+    }
+    if (view->itemsize != (Py_ssize_t)sizeof(TDA8425_Float) ||
+        strcmp(format, (sizeof(TDA8425_Float) == sizeof(float)) ? "f" : "d")) {
+        PyErr_Format(PyExc_TypeError, "%s: expecting a buffer of %s", name,
+                     (sizeof(TDA8425_Float) == sizeof(float)) ? "float32" : "float64");
+        PyBuffer_Release(view);
+        return 0;
+    }
+    return 1;
+}
+
+
+// Prevents concurrent use of a chip while the GIL is released
+static int Chip_Acquire(ChipObject* self)
+{
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "chip in use by another thread");
+        return 0;
+    }
+    self->busy = 1;
+    return 1;
+}
+
+
+// ============================================================================
+
+static PyObject* Chip_New(PyTypeObject* type, PyObject* args, PyObject* kwargs)
+{
+    (void)args;
+    (void)kwargs;
+
+    ChipObject* self = (ChipObject*)type->tp_alloc(type, 0);
+    if (self) {
+        self->chip = (TDA8425_Chip*)PyMem_Calloc(1, sizeof(TDA8425_Chip));
+        if (!self->chip) {
+            Py_DECREF(self);
+            return PyErr_NoMemory();
+        }
+        TDA8425_Chip_Ctor(self->chip);
+    }
+    return (PyObject*)self;
+}
+
+
+static void Chip_Dealloc(ChipObject* self)
+{
+    if (self->chip) {
+        TDA8425_Chip_Stop(self->chip);
+        TDA8425_Chip_Dtor(self->chip);
+        PyMem_Free(self->chip);
+    }
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+
+static int Chip_Init(ChipObject* self, PyObject* args, PyObject* kwargs)
+{
+    static char* keywords[] = { "rate", "pseudo_c1", "pseudo_c2", "tfilter", NULL };
+    double rate = 48000;
+    double pseudo_c1 = TDA8425_Pseudo_C1_Table[0];
+    double pseudo_c2 = TDA8425_Pseudo_C2_Table[0];
+    int tfilter = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|dddp:Chip", keywords,
+                                     &rate, &pseudo_c1, &pseudo_c2, &tfilter)) {
+        return -1;
+    }
+    if (!(rate > 0) || !(pseudo_c1 > 0) || !(pseudo_c2 > 0)) {
+        PyErr_SetString(PyExc_ValueError, "rate and capacitances must be positive");
+        return -1;
+    }
+    if (!Chip_Acquire(self)) {
+        return -1;
+    }
+    TDA8425_Chip_Setup(self->chip, (TDA8425_Float)rate, (TDA8425_Float)pseudo_c1, (TDA8425_Float)pseudo_c2,
+                       (tfilter ? TDA8425_Tfilter_Mode_Enabled : TDA8425_Tfilter_Mode_Disabled));
+    TDA8425_Chip_Reset(self->chip);
+    TDA8425_Chip_Start(self->chip);
+    self->busy = 0;
+    return 0;
+}
+
+
+// ----------------------------------------------------------------------------
+
+PyDoc_STRVAR(Chip_Reset__doc__,
+"reset()\n"
+"--\n"
+"\n"
+"Clears the registers.");
+
+static PyObject* Chip_Reset(ChipObject* self, PyObject* unused)
+{
+    (void)unused;
+
+    if (!Chip_Acquire(self)) {
+        return NULL;
+    }
+    TDA8425_Chip_Reset(self->chip);
+    self->busy = 0;
+    Py_RETURN_NONE;
+}
+
+
+PyDoc_STRVAR(Chip_Start__doc__,
+"start()\n"
+"--\n"
+"\n"
+"Clears the filter states.");
+
+static PyObject* Chip_Start(ChipObject* self, PyObject* unused)
+{
+    (void)unused;
+
+    if (!Chip_Acquire(self)) {
+        return NULL;
+    }
+    TDA8425_Chip_Start(self->chip);
+    self->busy = 0;
+    Py_RETURN_NONE;
+}
+
+
+PyDoc_STRVAR(Chip_Read__doc__,
+"read(address)\n"
+"--\n"
+"\n"
+"Reads a register, with unused bits set.");
+
+static PyObject* Chip_Read(ChipObject* self, PyObject* args)
+{
+    unsigned char address;
+
+    if (!PyArg_ParseTuple(args, "b:read", &address)) {
+        return NULL;
+    }
+    if (!Chip_Acquire(self)) {
+        return NULL;
+    }
+    TDA8425_Register data = TDA8425_Chip_Read(self->chip, (TDA8425_Address)address);
+    self->busy = 0;
+    return PyLong_FromLong((long)data);
+}
+
+
+PyDoc_STRVAR(Chip_Write__doc__,
+"write(address, data)\n"
+"--\n"
+"\n"
+"Writes a register.");
+
+static PyObject* Chip_Write(ChipObject* self, PyObject* args)
+{
+    unsigned char address;
+    unsigned char data;
+
+    if (!PyArg_ParseTuple(args, "bb:write", &address, &data)) {
+        return NULL;
+    }
+    if (!Chip_Acquire(self)) {
+        return NULL;
+    }
+    TDA8425_Chip_Write(self->chip, (TDA8425_Address)address, (TDA8425_Register)data);
+    self->busy = 0;
+    Py_RETURN_NONE;
+}
+
+
+PyDoc_STRVAR(Chip_ProcessBlock__doc__,
+"process_block(frames)\n"
+"--\n"
+"\n"
+"Processes frames in place, releasing the GIL.\n"
+"\n"
+"frames is a writable contiguous buffer of FRAME_FIELDS floats per frame,\n"
+"FLOAT_SIZE bytes each, as per TDA8425_Chip_Process_Data: the two stereo\n"
+"sources, then the stereo outputs; e.g. a numpy array of shape\n"
+"(count, FRAME_FIELDS), with [:, 0:4] as inputs and [:, 4:6] as outputs.");
+
+static PyObject* Chip_ProcessBlock(ChipObject* self, PyObject* args)
+{
+    PyObject* obj;
+    Py_buffer view;
+
+    if (!PyArg_ParseTuple(args, "O:process_block", &obj)) {
+        return NULL;
+    }
+    if (!GetFloatBuffer(obj, &view, 1, "frames")) {
+        return NULL;
+    }
+    if (view.len % (FRAME_FIELDS * view.itemsize)) {
+        PyErr_SetString(PyExc_ValueError, "frames: size not a multiple of FRAME_FIELDS");
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+    if (!Chip_Acquire(self)) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    TDA8425_Index count = (TDA8425_Index)(view.len / (FRAME_FIELDS * view.itemsize));
+    TDA8425_Chip* chip = self->chip;
+
+    Py_BEGIN_ALLOW_THREADS
+    TDA8425_Chip_ProcessBlock(chip, (TDA8425_Chip_Process_Data*)view.buf, count);
+    Py_END_ALLOW_THREADS
+
+    self->busy = 0;
+    PyBuffer_Release(&view);
+    return PyLong_FromSize_t((size_t)count);
+}
+
+
+PyDoc_STRVAR(Chip_GetResponse__doc__,
+"get_response(frequencies, magnitudes, phases=None, channel=0)\n"
+"--\n"
+"\n"
+"Evaluates the frequency response of the current settings, from an input\n"
+"channel to the same output channel, into the given buffers of floats,\n"
+"releasing the GIL. Magnitudes are linear, phases are in radians.");
+
+static PyObject* Chip_GetResponse(ChipObject* self, PyObject* args, PyObject* kwargs)
+{
+    static char* keywords[] = { "frequencies", "magnitudes", "phases", "channel", NULL };
+    PyObject* frequencies_obj;
+    PyObject* magnitudes_obj;
+    PyObject* phases_obj = Py_None;
+    int channel = TDA8425_Stereo_L;
+    Py_buffer frequencies;
+    Py_buffer magnitudes;
+    Py_buffer phases;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|Oi:get_response", keywords,
+                                     &frequencies_obj, &magnitudes_obj, &phases_obj, &channel)) {
+        return NULL;
+    }
+    if (channel != TDA8425_Stereo_L && channel != TDA8425_Stereo_R) {
+        PyErr_SetString(PyExc_ValueError, "channel must be 0 (left) or 1 (right)");
+        return NULL;
+    }
+    if (!GetFloatBuffer(frequencies_obj, &frequencies, 0, "frequencies")) {
+        return NULL;
+    }
+    if (!GetFloatBuffer(magnitudes_obj, &magnitudes, 1, "magnitudes")) {
+        PyBuffer_Release(&frequencies);
+        return NULL;
+    }
+    phases.buf = NULL;
+    if (phases_obj != Py_None && !GetFloatBuffer(phases_obj, &phases, 1, "phases")) {
+        PyBuffer_Release(&magnitudes);
+        PyBuffer_Release(&frequencies);
+        return NULL;
+    }
+
+    PyObject* result = NULL;
+    TDA8425_Index count = (TDA8425_Index)(frequencies.len / frequencies.itemsize);
+    if (magnitudes.len < frequencies.len || (phases.buf && phases.len < frequencies.len)) {
+        PyErr_SetString(PyExc_ValueError, "output buffers shorter than frequencies");
+    }
+    else if (Chip_Acquire(self)) {
+        TDA8425_Chip const* chip = self->chip;
+
+        Py_BEGIN_ALLOW_THREADS
+        TDA8425_Chip_GetResponse(chip, (TDA8425_Stereo)channel, (TDA8425_Float const*)frequencies.buf, count,
+                                 (TDA8425_Float*)magnitudes.buf, (TDA8425_Float*)phases.buf);
+        Py_END_ALLOW_THREADS
+
+        self->busy = 0;
+        result = PyLong_FromSize_t((size_t)count);
+    }
+
+    if (phases.buf) {
+        PyBuffer_Release(&phases);
+    }
+    PyBuffer_Release(&magnitudes);
+    PyBuffer_Release(&frequencies);
+    return result;
+}
+
+
+// ============================================================================
+
+static PyMethodDef Chip_Methods[] = {
+    { "reset", (PyCFunction)Chip_Reset, METH_NOARGS, Chip_Reset__doc__ },
+    { "start", (PyCFunction)Chip_Start, METH_NOARGS, Chip_Start__doc__ },
+    { "read", (PyCFunction)Chip_Read, METH_VARARGS, Chip_Read__doc__ },
+    { "write", (PyCFunction)Chip_Write, METH_VARARGS, Chip_Write__doc__ },
+    { "process_block", (PyCFunction)Chip_ProcessBlock, METH_VARARGS, Chip_ProcessBlock__doc__ },
+    { "get_response", (PyCFunction)(void (*)(void))Chip_GetResponse, METH_VARARGS | METH_KEYWORDS,
+      Chip_GetResponse__doc__ },
+    { NULL, NULL, 0, NULL }
+};
+
+PyDoc_STRVAR(Chip__doc__,
+"Chip(rate=48000, pseudo_c1=PSEUDO_C1[0], pseudo_c2=PSEUDO_C2[0], tfilter=False)\n"
+"--\n"
+"\n"
+"TDA8425 chip, set up, reset, and started.\n"
+"\n"
+"Register writes and processing of the same chip must not overlap; they\n"
+"raise RuntimeError if called while another thread is processing.");
+
+static PyTypeObject Chip_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "TDA8425.Chip",
+    .tp_basicsize = sizeof(ChipObject),
+    .tp_dealloc = (destructor)Chip_Dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = Chip__doc__,
+    .tp_methods = Chip_Methods,
+    .tp_init = (initproc)Chip_Init,
+    .tp_new = Chip_New,
+};
+
+
+// ============================================================================
+
+static PyObject* NewFloatTuple(TDA8425_Float const* values, Py_ssize_t count)
+{
+    PyObject* tuple = PyTuple_New(count);
+    for (Py_ssize_t i = 0; tuple && i < count; ++i) {
+        PyObject* item = PyFloat_FromDouble((double)values[i]);
+        if (!item) {
+            Py_DECREF(tuple);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(tuple, i, item);
+    }
+    return tuple;
+}
+
+
+// Adds a tuple of TDA8425_Float to the module; returns -1 with an exception set
+static int AddFloatTuple(PyObject* module, char const* name,
+                         TDA8425_Float const* values, Py_ssize_t count)
+{
+    PyObject* tuple = NewFloatTuple(values, count);
+    if (!tuple) {
+        return -1;
+    }
+    if (PyModule_AddObject(module, name, tuple) < 0) {
+        Py_DECREF(tuple);  // only stolen on success
+        return -1;
+    }
+    return 0;
+}
+
+
+static struct PyModuleDef TDA8425_Module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "TDA8425",
+    .m_doc = "TDA8425 emulator, processing float buffers in place.",
+    .m_size = -1,
+};
+
+
+PyMODINIT_FUNC PyInit_TDA8425(void)
+{
+    static struct {
+        char const* name;
+        long value;
+    } const CONSTANTS[] = {
+        { "REG_VL", TDA8425_Reg_VL },
+        { "REG_VR", TDA8425_Reg_VR },
+        { "REG_BA", TDA8425_Reg_BA },
+        { "REG_TR", TDA8425_Reg_TR },
+        { "REG_PP", TDA8425_Reg_PP },
+        { "REG_SF", TDA8425_Reg_SF },
+        { "MODE_FORCED_MONO", TDA8425_Mode_ForcedMono },
+        { "MODE_LINEAR_STEREO", TDA8425_Mode_LinearStereo },
+        { "MODE_PSEUDO_STEREO", TDA8425_Mode_PseudoStereo },
+        { "MODE_SPATIAL_STEREO", TDA8425_Mode_SpatialStereo },
+        { "FRAME_FIELDS", (long)FRAME_FIELDS },
+        { "FLOAT_SIZE", (long)sizeof(TDA8425_Float) },
+        { NULL, 0 }
+    };
+
+    if (PyType_Ready(&Chip_Type) < 0) {
+        return NULL;
+    }
+    PyObject* module = PyModule_Create(&TDA8425_Module);
+    if (!module) {
+        return NULL;
+    }
+
+    Py_INCREF(&Chip_Type);
+    if (PyModule_AddObject(module, "Chip", (PyObject*)&Chip_Type) < 0) {
+        Py_DECREF(&Chip_Type);
+        Py_DECREF(module);
+        return NULL;
+    }
+    for (int i = 0; CONSTANTS[i].name; ++i) {
+        if (PyModule_AddIntConstant(module, CONSTANTS[i].name, CONSTANTS[i].value) < 0) {
+            Py_DECREF(module);
+            return NULL;
+        }
+    }
+    if (PyModule_AddStringConstant(module, "VERSION", TDA8425_GetVersion()) < 0 ||
+        AddFloatTuple(module, "PSEUDO_C1", TDA8425_Pseudo_C1_Table,
+                      TDA8425_Pseudo_Preset_Count) < 0 ||
+        AddFloatTuple(module, "PSEUDO_C2", TDA8425_Pseudo_C2_Table,
+                      TDA8425_Pseudo_Preset_Count) < 0) {
+        Py_DECREF(module);
+        return NULL;
+    }
+    return module;
+}
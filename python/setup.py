@@ -0,0 +1,23 @@
+# Builds the TDA8425 CPython extension:
+#
+#     python3 setup.py build_ext --inplace
+#
+# Define TDA8425_FLOAT=float for single precision buffers.
+
+from setuptools import Extension
+from setuptools import setup
+
+setup(
+    name='TDA8425',
+    version='0.2.0',
+    description='TDA8425 emulator, processing float buffers in place',
+    license='BSD-2-Clause',
+    ext_modules=[
+        Extension(
+            'TDA8425',
+            sources=['TDA8425_module.c', '../src/TDA8425_emu.c'],
+            include_dirs=['../src'],
+            extra_compile_args=['-std=c99', '-O3'],
+        ),
+    ],
+)
@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <assert.h>
 #include <math.h>
+#include <string.h>
 
 #ifndef M_PI
 #define M_PI (3.14159265358979323846264338327950288)
@@ -546,6 +547,221 @@ TDA8425_Float TDA8425_BiLin_Process(
 
 // ============================================================================
 
+#if (TDA8425_BLOCK_SIZE < 4) || (TDA8425_BLOCK_SIZE & (TDA8425_BLOCK_SIZE - 1))
+#error "TDA8425_BLOCK_SIZE must be a power of two, at least 4"
+#endif
+
+#ifndef TDA8425_USE_VECTOR_EXTENSIONS
+#if defined(__GNUC__) || defined(__clang__)
+#define TDA8425_USE_VECTOR_EXTENSIONS 1
+#else
+#define TDA8425_USE_VECTOR_EXTENSIONS 0
+#endif
+#endif
+
+#if TDA8425_USE_VECTOR_EXTENSIONS
+//! Whole block of samples, split by the compiler into the widest SIMD registers
+typedef TDA8425_Float TDA8425_BlockVector
+    __attribute__((vector_size(sizeof(TDA8425_Float) * TDA8425_BLOCK_SIZE)));
+
+//! Unaligned load of a whole block
+#define TDA8425_BLOCKVECTOR_LOAD(dst_, src_)  (memcpy(&(dst_), (src_), sizeof(dst_)))
+#endif  // TDA8425_USE_VECTOR_EXTENSIONS
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_BiQuadBlock_Setup(
+    TDA8425_BiQuadBlock* block,
+    TDA8425_BiQuadModel const* model
+)
+{
+    assert(block);
+    assert(model);
+
+    TDA8425_BiQuadState state;
+    TDA8425_Float h[TDA8425_BLOCK_SIZE];
+
+    // Impulse response, as a lower triangular Toeplitz matrix
+    TDA8425_BiQuadState_Clear(&state, 0);
+    for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+        h[j] = TDA8425_BiQuad_Process(model, &state, (TDA8425_Float)(j == 0));
+    }
+
+    for (int k = 0; k < TDA8425_BLOCK_SIZE; ++k) {
+        for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+            block->impulse[k][j] = (j >= k) ? h[j - k] : 0;
+        }
+    }
+
+    // Zero-input responses to each state variable
+    for (int m = 0; m < 4; ++m) {
+        TDA8425_BiQuadState_Clear(&state, 0);
+        state.x0 = (TDA8425_Float)(m == 0);
+        state.x1 = (TDA8425_Float)(m == 1);
+        state.y0 = (TDA8425_Float)(m == 2);
+        state.y1 = (TDA8425_Float)(m == 3);
+
+        for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+            block->state[m][j] = TDA8425_BiQuad_Process(model, &state, 0);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_BiQuadBlock_Process(
+    TDA8425_BiQuadBlock const* block,
+    TDA8425_BiQuadState* state,
+    TDA8425_Float const inputs[TDA8425_BLOCK_SIZE],
+    TDA8425_Float outputs[TDA8425_BLOCK_SIZE]
+)
+{
+    assert(block);
+    assert(state);
+    assert(inputs);
+    assert(outputs);
+
+    // All the outputs of the block are independent of each other, so they
+    // map onto the SIMD lanes
+    TDA8425_Float y[TDA8425_BLOCK_SIZE];
+    TDA8425_Float x0 = state->x0;
+    TDA8425_Float x1 = state->x1;
+    TDA8425_Float y0 = state->y0;
+    TDA8425_Float y1 = state->y1;
+
+#if TDA8425_USE_VECTOR_EXTENSIONS
+    TDA8425_BlockVector v, h;
+    TDA8425_BLOCKVECTOR_LOAD(h, block->state[0]);  v  = x0 * h;
+    TDA8425_BLOCKVECTOR_LOAD(h, block->state[1]);  v += x1 * h;
+    TDA8425_BLOCKVECTOR_LOAD(h, block->state[2]);  v += y0 * h;
+    TDA8425_BLOCKVECTOR_LOAD(h, block->state[3]);  v += y1 * h;
+
+    for (int k = 0; k < TDA8425_BLOCK_SIZE; ++k) {
+        TDA8425_BLOCKVECTOR_LOAD(h, block->impulse[k]);
+        v += inputs[k] * h;
+    }
+    memcpy(y, &v, sizeof(y));
+#else
+    for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+        y[j] = (x0 * block->state[0][j] +
+                x1 * block->state[1][j] +
+                y0 * block->state[2][j] +
+                y1 * block->state[3][j]);
+    }
+
+    for (int k = 0; k < TDA8425_BLOCK_SIZE; ++k) {
+        TDA8425_Float xk = inputs[k];
+        for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+            y[j] += xk * block->impulse[k][j];
+        }
+    }
+#endif  // TDA8425_USE_VECTOR_EXTENSIONS
+
+    state->x2 = inputs[TDA8425_BLOCK_SIZE - 3];
+    state->x1 = inputs[TDA8425_BLOCK_SIZE - 2];
+    state->x0 = inputs[TDA8425_BLOCK_SIZE - 1];
+
+    state->y2 = y[TDA8425_BLOCK_SIZE - 3];
+    state->y1 = y[TDA8425_BLOCK_SIZE - 2];
+    state->y0 = y[TDA8425_BLOCK_SIZE - 1];
+
+    for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+        outputs[j] = y[j];
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_BiLinBlock_Setup(
+    TDA8425_BiLinBlock* block,
+    TDA8425_BiLinModel const* model
+)
+{
+    assert(block);
+    assert(model);
+
+    TDA8425_BiLinState state;
+    TDA8425_Float h[TDA8425_BLOCK_SIZE];
+
+    // Impulse response, as a lower triangular Toeplitz matrix
+    TDA8425_BiLinState_Clear(&state, 0);
+    for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+        h[j] = TDA8425_BiLin_Process(model, &state, (TDA8425_Float)(j == 0));
+    }
+
+    for (int k = 0; k < TDA8425_BLOCK_SIZE; ++k) {
+        for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+            block->impulse[k][j] = (j >= k) ? h[j - k] : 0;
+        }
+    }
+
+    // Zero-input responses to each state variable
+    for (int m = 0; m < 2; ++m) {
+        TDA8425_BiLinState_Clear(&state, 0);
+        state.x0 = (TDA8425_Float)(m == 0);
+        state.y0 = (TDA8425_Float)(m == 1);
+
+        for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+            block->state[m][j] = TDA8425_BiLin_Process(model, &state, 0);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_BiLinBlock_Process(
+    TDA8425_BiLinBlock const* block,
+    TDA8425_BiLinState* state,
+    TDA8425_Float const inputs[TDA8425_BLOCK_SIZE],
+    TDA8425_Float outputs[TDA8425_BLOCK_SIZE]
+)
+{
+    assert(block);
+    assert(state);
+    assert(inputs);
+    assert(outputs);
+
+    TDA8425_Float y[TDA8425_BLOCK_SIZE];
+    TDA8425_Float x0 = state->x0;
+    TDA8425_Float y0 = state->y0;
+
+#if TDA8425_USE_VECTOR_EXTENSIONS
+    TDA8425_BlockVector v, h;
+    TDA8425_BLOCKVECTOR_LOAD(h, block->state[0]);  v  = x0 * h;
+    TDA8425_BLOCKVECTOR_LOAD(h, block->state[1]);  v += y0 * h;
+
+    for (int k = 0; k < TDA8425_BLOCK_SIZE; ++k) {
+        TDA8425_BLOCKVECTOR_LOAD(h, block->impulse[k]);
+        v += inputs[k] * h;
+    }
+    memcpy(y, &v, sizeof(y));
+#else
+    for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+        y[j] = (x0 * block->state[0][j] +
+                y0 * block->state[1][j]);
+    }
+
+    for (int k = 0; k < TDA8425_BLOCK_SIZE; ++k) {
+        TDA8425_Float xk = inputs[k];
+        for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+            y[j] += xk * block->impulse[k][j];
+        }
+    }
+#endif  // TDA8425_USE_VECTOR_EXTENSIONS
+
+    state->x1 = inputs[TDA8425_BLOCK_SIZE - 2];
+    state->x0 = inputs[TDA8425_BLOCK_SIZE - 1];
+
+    state->y1 = y[TDA8425_BLOCK_SIZE - 2];
+    state->y0 = y[TDA8425_BLOCK_SIZE - 1];
+
+    for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+        outputs[j] = y[j];
+    }
+}
+
+// ============================================================================
+
 void TDA8425_DCRemoval_Process(
     TDA8425_Float stereo[TDA8425_Stereo_Count],
     TDA8425_BiLinModel const* model,
@@ -613,10 +829,112 @@ void TDA8425_SpatialStereo_Process(
 
 // ============================================================================
 
+//! Block models to refresh before block processing
+enum TDA8425_BlockDirty {
+    TDA8425_BlockDirty_DCRemoval = 1 << 0,
+    TDA8425_BlockDirty_Pseudo    = 1 << 1,
+    TDA8425_BlockDirty_Bass      = 1 << 2,
+    TDA8425_BlockDirty_Treble    = 1 << 3,
+    TDA8425_BlockDirty_Tfilter   = 1 << 4,
+
+    TDA8425_BlockDirty_All       = (1 << 5) - 1
+};
+
+// ----------------------------------------------------------------------------
+
+#if TDA8425_USE_COUNTERS
+#define TDA8425_COUNT(self_, counter_, value_)  ((self_)->counters_.counter_ += (uint64_t)(value_))
+#else
+#define TDA8425_COUNT(self_, counter_, value_)  ((void)0)
+#endif
+
+#if TDA8425_USE_COUNTERS >= 2
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define TDA8425_READ_CYCLES()  ((uint64_t)__rdtsc())
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+#define TDA8425_READ_CYCLES()  ((uint64_t)__builtin_ia32_rdtsc())
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+static inline uint64_t TDA8425_ReadCycles(void)
+{
+    uint64_t ticks;
+    __asm__ __volatile__ ("mrs %0, cntvct_el0" : "=r" (ticks));
+    return ticks;
+}
+#define TDA8425_READ_CYCLES()  (TDA8425_ReadCycles())
+#else
+#define TDA8425_READ_CYCLES()  ((uint64_t)0)  // no cycle counter
+#endif
+
+#define TDA8425_CYCLES_BEGIN(var_)  uint64_t var_ = TDA8425_READ_CYCLES()
+
+#define TDA8425_CYCLES_LAP(self_, counter_, var_) do {      \
+    uint64_t now_ = TDA8425_READ_CYCLES();                  \
+    (self_)->counters_.counter_ += now_ - (var_);           \
+    (var_) = now_;                                          \
+} while (0)
+
+#else
+#define TDA8425_CYCLES_BEGIN(var_)                 ((void)0)
+#define TDA8425_CYCLES_LAP(self_, counter_, var_)  ((void)0)
+#endif  // TDA8425_USE_COUNTERS >= 2
+
+static void TDA8425_Chip_WriteRegister(
+    TDA8425_Chip* self,
+    TDA8425_Address address,
+    TDA8425_Register data
+);
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_Meter_UpdatePeak(
+    TDA8425_Float* peak,
+    TDA8425_Float const samples[],
+    int count
+)
+{
+    TDA8425_Float p = *peak;
+
+    for (int j = 0; j < count; ++j) {
+        TDA8425_Float a = (samples[j] < 0) ? -samples[j] : samples[j];
+        p = (a > p) ? a : p;
+    }
+    *peak = p;
+}
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_Meter_UpdateOutput(
+    TDA8425_Meter* meter,
+    int channel,
+    TDA8425_Float const samples[],
+    int count
+)
+{
+    TDA8425_Float p = meter->peak[channel];
+    TDA8425_Float e = 0;
+    unsigned clips = 0;
+
+    for (int j = 0; j < count; ++j) {
+        TDA8425_Float a = (samples[j] < 0) ? -samples[j] : samples[j];
+        p = (a > p) ? a : p;
+        e += samples[j] * samples[j];
+        clips += (a > 1);
+    }
+    meter->peak[channel] = p;
+    meter->energy[channel] += e;
+    meter->clips[channel] += clips;
+}
+
+// ============================================================================
+
 void TDA8425_Chip_Ctor(TDA8425_Chip* self)
 {
-    (void)self;
     assert(self);
+
+    self->recorder_ = NULL;
+    self->meter_ = NULL;
+    TDA8425_Chip_ResetCounters(self);
 }
 
 // ----------------------------------------------------------------------------
@@ -646,6 +964,7 @@ void TDA8425_Chip_Setup(
     self->sample_rate_ = sample_rate;
     self->pseudo_c1_ = pseudo_c1;
     self->pseudo_c2_ = pseudo_c2;
+    self->blocks_dirty_ = TDA8425_BlockDirty_All;
 
     TDA8425_BiLinModel_SetupDCRemoval(
         &self->dcremoval_model_,
@@ -658,9 +977,10 @@ void TDA8425_Chip_Setup(
         pseudo_c1,
         pseudo_c2
     );
+    TDA8425_COUNT(self, coefficient_updates, 2);
 
-    TDA8425_Chip_Write(self, (TDA8425_Address)TDA8425_Reg_BA, self->reg_ba_);
-    TDA8425_Chip_Write(self, (TDA8425_Address)TDA8425_Reg_TR, self->reg_tr_);
+    TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_BA, self->reg_ba_);
+    TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_TR, self->reg_tr_);
 }
 
 // ----------------------------------------------------------------------------
@@ -669,11 +989,11 @@ void TDA8425_Chip_Reset(TDA8425_Chip* self)
 {
     assert(self);
 
-    TDA8425_Chip_Write(self, (TDA8425_Address)TDA8425_Reg_VL, 0);
-    TDA8425_Chip_Write(self, (TDA8425_Address)TDA8425_Reg_VR, 0);
-    TDA8425_Chip_Write(self, (TDA8425_Address)TDA8425_Reg_BA, 0);
-    TDA8425_Chip_Write(self, (TDA8425_Address)TDA8425_Reg_TR, 0);
-    TDA8425_Chip_Write(self, (TDA8425_Address)TDA8425_Reg_SF, 0);
+    TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_VL, 0);
+    TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_VR, 0);
+    TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_BA, 0);
+    TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_TR, 0);
+    TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_SF, 0);
 }
 
 // ----------------------------------------------------------------------------
@@ -685,6 +1005,7 @@ void TDA8425_Chip_Start(TDA8425_Chip* self)
     TDA8425_BiQuadState_Clear(&self->pseudo_state_, 0);
 
     for (int i = 0; i < TDA8425_Stereo_Count; ++i) {
+        TDA8425_BiLinState_Clear(&self->dcremoval_state_[i], 0);
         TDA8425_BiLinState_Clear(&self->bass_state_[i], 0);
         TDA8425_BiLinState_Clear(&self->treble_state_[i], 0);
         TDA8425_BiQuadState_Clear(&self->tfilter_state_[i], 0);
@@ -703,12 +1024,12 @@ void TDA8425_Chip_Stop(TDA8425_Chip* self)
 
 static void TDA8425_Chip_ProcessSelector(
     TDA8425_Chip* self,
-    TDA8425_Chip_Process_Data* data,
+    TDA8425_Float const inputs[TDA8425_Source_Count][TDA8425_Stereo_Count],
     TDA8425_Float stereo[TDA8425_Stereo_Count]
 )
 {
     assert(self);
-    assert(data);
+    assert(inputs);
     assert(stereo);
 
     TDA8425_Source const S1 = TDA8425_Source_1;
@@ -719,33 +1040,33 @@ static void TDA8425_Chip_ProcessSelector(
     switch (self->selector_)
     {
     case TDA8425_Selector_Sound_A_1:
-        stereo[L] = data->inputs[S1][L];
-        stereo[R] = data->inputs[S1][L];
+        stereo[L] = inputs[S1][L];
+        stereo[R] = inputs[S1][L];
         break;
 
     case TDA8425_Selector_Sound_A_2:
-        stereo[L] = data->inputs[S2][L];
-        stereo[R] = data->inputs[S2][L];
+        stereo[L] = inputs[S2][L];
+        stereo[R] = inputs[S2][L];
         break;
 
     case TDA8425_Selector_Sound_B_1:
-        stereo[L] = data->inputs[S1][R];
-        stereo[R] = data->inputs[S1][R];
+        stereo[L] = inputs[S1][R];
+        stereo[R] = inputs[S1][R];
         break;
 
     case TDA8425_Selector_Sound_B_2:
-        stereo[L] = data->inputs[S2][L];
-        stereo[R] = data->inputs[S2][R];
+        stereo[L] = inputs[S2][L];
+        stereo[R] = inputs[S2][R];
         break;
 
     case TDA8425_Selector_Stereo_1:
-        stereo[L] = data->inputs[S1][L];
-        stereo[R] = data->inputs[S1][R];
+        stereo[L] = inputs[S1][L];
+        stereo[R] = inputs[S1][R];
         break;
 
     case TDA8425_Selector_Stereo_2:
-        stereo[L] = data->inputs[S2][L];
-        stereo[R] = data->inputs[S2][R];
+        stereo[L] = inputs[S2][L];
+        stereo[R] = inputs[S2][R];
         break;
 
     default:
@@ -791,17 +1112,46 @@ static void TDA8425_Chip_ProcessMode(
 
 // ----------------------------------------------------------------------------
 
-void TDA8425_Chip_Process(
+static void TDA8425_Chip_StoreTap(
+    TDA8425_Float* const taps[TDA8425_Tap_Count],
+    TDA8425_Tap tap,
+    TDA8425_Index offset,
+    int channel,
+    TDA8425_Float const samples[],
+    int count
+)
+{
+    TDA8425_Float* frames = taps[tap];
+
+    if (frames) {
+        frames += (offset * TDA8425_Stereo_Count) + (TDA8425_Index)channel;
+
+        for (int j = 0; j < count; ++j) {
+            frames[j * TDA8425_Stereo_Count] = samples[j];
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_Chip_ProcessStereoTaps(
     TDA8425_Chip* self,
-    TDA8425_Chip_Process_Data* data
+    TDA8425_Float stereo[TDA8425_Stereo_Count],
+    TDA8425_Float outputs[TDA8425_Stereo_Count],
+    TDA8425_Float* const taps[TDA8425_Tap_Count],
+    TDA8425_Index offset
 )
 {
     assert(self);
-    assert(data);
-
-    TDA8425_Float stereo[TDA8425_Stereo_Count] = { 0, 0 };
+    assert(stereo);
+    assert(outputs);
 
-    TDA8425_Chip_ProcessSelector(self, data, stereo);
+    TDA8425_CYCLES_BEGIN(cycles);
+    TDA8425_COUNT(self, frames, 1);
+    TDA8425_COUNT(self, idle_frames, (self->reg_sf_ >> TDA8425_Reg_SF_MU) & 1);
+    TDA8425_COUNT(self, bypass_frames[TDA8425_Stage_DCRemoval], !self->dcremoval_mode_);
+    TDA8425_COUNT(self, bypass_frames[TDA8425_Stage_Mode], self->mode_ == TDA8425_Mode_LinearStereo);
+    TDA8425_COUNT(self, bypass_frames[TDA8425_Stage_Tfilter], !self->tfilter_mode_);
 
     if (self->dcremoval_mode_) {
         TDA8425_DCRemoval_Process(
@@ -810,26 +1160,56 @@ void TDA8425_Chip_Process(
             self->dcremoval_state_
         );
     }
+    TDA8425_CYCLES_LAP(self, stage_cycles[TDA8425_Stage_DCRemoval], cycles);
+
+    if (taps) {
+        TDA8425_Chip_StoreTap(taps, TDA8425_Tap_DCRemoval, offset, TDA8425_Stereo_L, &stereo[TDA8425_Stereo_L], 1);
+        TDA8425_Chip_StoreTap(taps, TDA8425_Tap_DCRemoval, offset, TDA8425_Stereo_R, &stereo[TDA8425_Stereo_R], 1);
+    }
 
     TDA8425_Chip_ProcessMode(self, stereo);
+    TDA8425_CYCLES_LAP(self, stage_cycles[TDA8425_Stage_Mode], cycles);
+
+    if (taps) {
+        TDA8425_Chip_StoreTap(taps, TDA8425_Tap_Mode, offset, TDA8425_Stereo_L, &stereo[TDA8425_Stereo_L], 1);
+        TDA8425_Chip_StoreTap(taps, TDA8425_Tap_Mode, offset, TDA8425_Stereo_R, &stereo[TDA8425_Stereo_R], 1);
+    }
+
+    TDA8425_Meter* meter = self->meter_;
 
     for (int channel = 0; channel < TDA8425_Stereo_Count; ++channel) {
         TDA8425_Float sample = self->volume_[channel] * stereo[channel];
 
+        if (meter) {
+            TDA8425_Meter_UpdatePeak(&meter->volume_peak[channel], &sample, 1);
+        }
+
         sample = TDA8425_BiLin_Process(
             &self->bass_model_,
             &self->bass_state_[channel],
             sample
         );
 
+        if (meter) {
+            TDA8425_Meter_UpdatePeak(&meter->bass_peak[channel], &sample, 1);
+        }
+        if (taps) {
+            TDA8425_Chip_StoreTap(taps, TDA8425_Tap_Bass, offset, channel, &sample, 1);
+        }
+
         sample = TDA8425_BiLin_Process(
             &self->treble_model_,
             &self->treble_state_[channel],
             sample
         );
+        TDA8425_CYCLES_LAP(self, stage_cycles[TDA8425_Stage_Tone], cycles);
+
+        if (taps) {
+            TDA8425_Chip_StoreTap(taps, TDA8425_Tap_Treble, offset, channel, &sample, 1);
+        }
 
         if (self->tfilter_mode_ == TDA8425_Tfilter_Mode_Disabled) {
-            data->outputs[channel] = sample;  // shortcut
+            outputs[channel] = sample;  // shortcut
         }
         else {
             sample = TDA8425_BiQuad_Process(
@@ -838,109 +1218,478 @@ void TDA8425_Chip_Process(
                 sample
             );
 
-            data->outputs[channel] = sample;
+            outputs[channel] = sample;
         }
+        TDA8425_CYCLES_LAP(self, stage_cycles[TDA8425_Stage_Tfilter], cycles);
+
+        if (meter) {
+            TDA8425_Meter_UpdateOutput(meter, channel, &outputs[channel], 1);
+        }
+    }
+
+    if (meter) {
+        ++meter->frames;
     }
 }
 
 // ----------------------------------------------------------------------------
 
-TDA8425_Register TDA8425_Chip_Read(
-    TDA8425_Chip const* self,
-    TDA8425_Address address
+static void TDA8425_Chip_ProcessStereo(
+    TDA8425_Chip* self,
+    TDA8425_Float stereo[TDA8425_Stereo_Count],
+    TDA8425_Float outputs[TDA8425_Stereo_Count]
 )
 {
-    assert(self);
+    TDA8425_Chip_ProcessStereoTaps(self, stereo, outputs, NULL, 0);
+}
 
-    switch ((TDA8425_Reg)address)
-    {
-    case TDA8425_Reg_VL:
-        return self->reg_vl_ | (TDA8425_Register)~TDA8425_Volume_Data_Mask;
+// ----------------------------------------------------------------------------
 
-    case TDA8425_Reg_VR:
-        return self->reg_vr_ | (TDA8425_Register)~TDA8425_Volume_Data_Mask;
+static void TDA8425_Chip_ProcessTaps(
+    TDA8425_Chip* self,
+    TDA8425_Chip_Process_Data* data,
+    TDA8425_Float* const taps[TDA8425_Tap_Count],
+    TDA8425_Index offset
+)
+{
+    assert(self);
+    assert(data);
 
-    case TDA8425_Reg_BA:
-        return self->reg_ba_ | (TDA8425_Register)~TDA8425_Tone_Data_Mask;
+    TDA8425_Float stereo[TDA8425_Stereo_Count] = { 0, 0 };
+    TDA8425_CYCLES_BEGIN(cycles);
 
-    case TDA8425_Reg_TR:
-        return self->reg_tr_ | (TDA8425_Register)~TDA8425_Tone_Data_Mask;
+    TDA8425_Chip_ProcessSelector(
+        self,
+        (TDA8425_Float const (*)[TDA8425_Stereo_Count])data->inputs,
+        stereo
+    );
+    TDA8425_CYCLES_LAP(self, stage_cycles[TDA8425_Stage_Selector], cycles);
 
-    case TDA8425_Reg_SF:
-        return self->reg_sf_ | (TDA8425_Register)~TDA8425_Switch_Data_Mask;
+    if (taps) {
+        TDA8425_Chip_StoreTap(taps, TDA8425_Tap_Selector, offset, TDA8425_Stereo_L, &stereo[TDA8425_Stereo_L], 1);
+        TDA8425_Chip_StoreTap(taps, TDA8425_Tap_Selector, offset, TDA8425_Stereo_R, &stereo[TDA8425_Stereo_R], 1);
+    }
 
-    default:
-        return (TDA8425_Register)~0;
+    TDA8425_Chip_ProcessStereoTaps(self, stereo, data->outputs, taps, offset);
+
+    if (self->recorder_) {
+        ++self->recorder_->frame_;
     }
 }
 
 // ----------------------------------------------------------------------------
 
-void TDA8425_Chip_Write(
+void TDA8425_Chip_Process(
     TDA8425_Chip* self,
-    TDA8425_Address address,
-    TDA8425_Register data
+    TDA8425_Chip_Process_Data* data
 )
 {
-    assert(self);
+    TDA8425_Chip_ProcessTaps(self, data, NULL, 0);
+}
 
-    switch ((TDA8425_Reg)address)
-    {
-    case TDA8425_Reg_VL: {
-        data |= (TDA8425_Register)~TDA8425_Volume_Data_Mask;
-        self->reg_vl_ = data;
+// ----------------------------------------------------------------------------
 
-        if (self->reg_sf_ & (1 << TDA8425_Reg_SF_MU)) {
-            data = 0;
-        }
-        self->volume_[TDA8425_Stereo_L] = TDA8425_RegisterToVolume(data);
-        break;
-    }
+static void TDA8425_Chip_SetupBlocks(TDA8425_Chip* self)
+{
+    assert(self);
 
-    case TDA8425_Reg_VR: {
-        data |= (TDA8425_Register)~TDA8425_Volume_Data_Mask;
-        self->reg_vr_ = data;
+    unsigned dirty = self->blocks_dirty_;
 
-        if (self->reg_sf_ & (1 << TDA8425_Reg_SF_MU)) {
-            data = 0;
-        }
-        self->volume_[TDA8425_Stereo_R] = TDA8425_RegisterToVolume(data);
-        break;
+    if (dirty & TDA8425_BlockDirty_DCRemoval) {
+        TDA8425_BiLinBlock_Setup(&self->dcremoval_block_, &self->dcremoval_model_);
+        TDA8425_COUNT(self, block_updates, 1);
+    }
+    if (dirty & TDA8425_BlockDirty_Pseudo) {
+        TDA8425_BiQuadBlock_Setup(&self->pseudo_block_, &self->pseudo_model_);
+        TDA8425_COUNT(self, block_updates, 1);
+    }
+    if (dirty & TDA8425_BlockDirty_Bass) {
+        TDA8425_BiLinBlock_Setup(&self->bass_block_, &self->bass_model_);
+        TDA8425_COUNT(self, block_updates, 1);
+    }
+    if (dirty & TDA8425_BlockDirty_Treble) {
+        TDA8425_BiLinBlock_Setup(&self->treble_block_, &self->treble_model_);
+        TDA8425_COUNT(self, block_updates, 1);
     }
+    if (dirty & TDA8425_BlockDirty_Tfilter) {
+        TDA8425_BiQuadBlock_Setup(&self->tfilter_block_, &self->tfilter_model_);
+        TDA8425_COUNT(self, block_updates, 1);
+    }
+    self->blocks_dirty_ = 0;
+}
 
-    case TDA8425_Reg_BA: {
-        data |= (TDA8425_Register)~TDA8425_Tone_Data_Mask;
-        self->reg_ba_ = data;
+// ----------------------------------------------------------------------------
 
-        TDA8425_Float bass_gain = TDA8425_RegisterToBass(data);
+static void TDA8425_Chip_ProcessSelectorBlock(
+    TDA8425_Chip* self,
+    TDA8425_Chip_Process_Data const data[TDA8425_BLOCK_SIZE],
+    TDA8425_Float buffer[TDA8425_Stereo_Count][TDA8425_BLOCK_SIZE]
+)
+{
+    assert(self);
+    assert(data);
+    assert(buffer);
 
-        TDA8425_BiLinModel_SetupBass(
-            &self->bass_model_,
-            self->sample_rate_,
-            bass_gain
-        );
+    TDA8425_Source const S1 = TDA8425_Source_1;
+    TDA8425_Source const S2 = TDA8425_Source_2;
+    TDA8425_Stereo const L = TDA8425_Stereo_L;
+    TDA8425_Stereo const R = TDA8425_Stereo_R;
+    int source_l;
+    int source_r;
+    int channel_l;
+    int channel_r;
 
-        if (self->tfilter_mode_) {
-            TDA8425_BiQuadModel_SetupTfilter(
-                &self->tfilter_model_,
-                self->sample_rate_,
-                bass_gain
-            );
-        }
+    switch (self->selector_)
+    {
+    case TDA8425_Selector_Sound_A_1:
+        source_l = S1; channel_l = L;
+        source_r = S1; channel_r = L;
         break;
-    }
 
-    case TDA8425_Reg_TR: {
-        data |= (TDA8425_Register)~TDA8425_Tone_Data_Mask;
-        self->reg_tr_ = data;
+    case TDA8425_Selector_Sound_A_2:
+        source_l = S2; channel_l = L;
+        source_r = S2; channel_r = L;
+        break;
 
-        TDA8425_Float treble_gain = TDA8425_RegisterToTreble(data);
+    case TDA8425_Selector_Sound_B_1:
+        source_l = S1; channel_l = R;
+        source_r = S1; channel_r = R;
+        break;
+
+    case TDA8425_Selector_Sound_B_2:
+        source_l = S2; channel_l = L;
+        source_r = S2; channel_r = R;
+        break;
+
+    case TDA8425_Selector_Stereo_1:
+        source_l = S1; channel_l = L;
+        source_r = S1; channel_r = R;
+        break;
+
+    case TDA8425_Selector_Stereo_2:
+        source_l = S2; channel_l = L;
+        source_r = S2; channel_r = R;
+        break;
+
+    default:
+        for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+            buffer[L][j] = 0;
+            buffer[R][j] = 0;
+        }
+        return;
+    }
+
+    for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+        buffer[L][j] = data[j].inputs[source_l][channel_l];
+        buffer[R][j] = data[j].inputs[source_r][channel_r];
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_Chip_ProcessBlockKernel(
+    TDA8425_Chip* self,
+    TDA8425_Chip_Process_Data data[TDA8425_BLOCK_SIZE],
+    TDA8425_Float* const taps[TDA8425_Tap_Count],
+    TDA8425_Index offset
+)
+{
+    assert(self);
+    assert(data);
+
+    TDA8425_Stereo const L = TDA8425_Stereo_L;
+    TDA8425_Stereo const R = TDA8425_Stereo_R;
+    TDA8425_Float buffer[TDA8425_Stereo_Count][TDA8425_BLOCK_SIZE];
+    TDA8425_CYCLES_BEGIN(cycles);
+
+    TDA8425_COUNT(self, frames, TDA8425_BLOCK_SIZE);
+    TDA8425_COUNT(self, block_frames, TDA8425_BLOCK_SIZE);
+    TDA8425_COUNT(self, idle_frames, ((self->reg_sf_ >> TDA8425_Reg_SF_MU) & 1) * TDA8425_BLOCK_SIZE);
+    TDA8425_COUNT(self, bypass_frames[TDA8425_Stage_DCRemoval], !self->dcremoval_mode_ * TDA8425_BLOCK_SIZE);
+    TDA8425_COUNT(self, bypass_frames[TDA8425_Stage_Mode],
+                  (self->mode_ == TDA8425_Mode_LinearStereo) * TDA8425_BLOCK_SIZE);
+    TDA8425_COUNT(self, bypass_frames[TDA8425_Stage_Tfilter], !self->tfilter_mode_ * TDA8425_BLOCK_SIZE);
+
+    TDA8425_Chip_ProcessSelectorBlock(self, data, buffer);
+    TDA8425_CYCLES_LAP(self, stage_cycles[TDA8425_Stage_Selector], cycles);
+
+    if (taps) {
+        TDA8425_Chip_StoreTap(taps, TDA8425_Tap_Selector, offset, L, buffer[L], TDA8425_BLOCK_SIZE);
+        TDA8425_Chip_StoreTap(taps, TDA8425_Tap_Selector, offset, R, buffer[R], TDA8425_BLOCK_SIZE);
+    }
+
+    if (self->dcremoval_mode_) {
+        for (int channel = 0; channel < TDA8425_Stereo_Count; ++channel) {
+            TDA8425_BiLinBlock_Process(
+                &self->dcremoval_block_,
+                &self->dcremoval_state_[channel],
+                buffer[channel],
+                buffer[channel]
+            );
+        }
+    }
+    TDA8425_CYCLES_LAP(self, stage_cycles[TDA8425_Stage_DCRemoval], cycles);
+
+    if (taps) {
+        TDA8425_Chip_StoreTap(taps, TDA8425_Tap_DCRemoval, offset, L, buffer[L], TDA8425_BLOCK_SIZE);
+        TDA8425_Chip_StoreTap(taps, TDA8425_Tap_DCRemoval, offset, R, buffer[R], TDA8425_BLOCK_SIZE);
+    }
+
+    switch (self->mode_)
+    {
+    case TDA8425_Mode_ForcedMono:
+        for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+            TDA8425_Float m = buffer[L][j] + buffer[R][j];
+            buffer[L][j] = m;
+            buffer[R][j] = m;
+        }
+        break;
+
+    case TDA8425_Mode_LinearStereo:
+        break;
+
+    case TDA8425_Mode_PseudoStereo:
+        TDA8425_BiQuadBlock_Process(
+            &self->pseudo_block_,
+            &self->pseudo_state_,
+            buffer[L],
+            buffer[L]
+        );
+        break;
+
+    case TDA8425_Mode_SpatialStereo: {
+        TDA8425_Float const k = ((TDA8425_Float)TDA8425_Spatial_Crosstalk / 100);
+        for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+            TDA8425_Float l = buffer[L][j];
+            TDA8425_Float r = buffer[R][j];
+            buffer[L][j] = l + (l - r) * k;
+            buffer[R][j] = r + (r - l) * k;
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+    TDA8425_CYCLES_LAP(self, stage_cycles[TDA8425_Stage_Mode], cycles);
+
+    if (taps) {
+        TDA8425_Chip_StoreTap(taps, TDA8425_Tap_Mode, offset, L, buffer[L], TDA8425_BLOCK_SIZE);
+        TDA8425_Chip_StoreTap(taps, TDA8425_Tap_Mode, offset, R, buffer[R], TDA8425_BLOCK_SIZE);
+    }
+
+    TDA8425_Meter* meter = self->meter_;
+
+    for (int channel = 0; channel < TDA8425_Stereo_Count; ++channel) {
+        TDA8425_Float* samples = buffer[channel];
+        TDA8425_Float volume = self->volume_[channel];
+
+        for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+            samples[j] *= volume;
+        }
+
+        if (meter) {
+            TDA8425_Meter_UpdatePeak(&meter->volume_peak[channel], samples, TDA8425_BLOCK_SIZE);
+        }
+
+        TDA8425_BiLinBlock_Process(
+            &self->bass_block_,
+            &self->bass_state_[channel],
+            samples,
+            samples
+        );
+
+        if (meter) {
+            TDA8425_Meter_UpdatePeak(&meter->bass_peak[channel], samples, TDA8425_BLOCK_SIZE);
+        }
+        if (taps) {
+            TDA8425_Chip_StoreTap(taps, TDA8425_Tap_Bass, offset, channel, samples, TDA8425_BLOCK_SIZE);
+        }
+
+        TDA8425_BiLinBlock_Process(
+            &self->treble_block_,
+            &self->treble_state_[channel],
+            samples,
+            samples
+        );
+        TDA8425_CYCLES_LAP(self, stage_cycles[TDA8425_Stage_Tone], cycles);
+
+        if (taps) {
+            TDA8425_Chip_StoreTap(taps, TDA8425_Tap_Treble, offset, channel, samples, TDA8425_BLOCK_SIZE);
+        }
+
+        if (self->tfilter_mode_ != TDA8425_Tfilter_Mode_Disabled) {
+            TDA8425_BiQuadBlock_Process(
+                &self->tfilter_block_,
+                &self->tfilter_state_[channel],
+                samples,
+                samples
+            );
+        }
+
+        for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+            data[j].outputs[channel] = samples[j];
+        }
+        TDA8425_CYCLES_LAP(self, stage_cycles[TDA8425_Stage_Tfilter], cycles);
+
+        if (meter) {
+            TDA8425_Meter_UpdateOutput(meter, channel, samples, TDA8425_BLOCK_SIZE);
+        }
+    }
+
+    if (meter) {
+        meter->frames += TDA8425_BLOCK_SIZE;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_ProcessBlock(
+    TDA8425_Chip* self,
+    TDA8425_Chip_Process_Data data[],
+    TDA8425_Index count
+)
+{
+    TDA8425_Chip_ProcessBlockTaps(self, data, count, NULL);
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_ProcessBlockTaps(
+    TDA8425_Chip* self,
+    TDA8425_Chip_Process_Data data[],
+    TDA8425_Index count,
+    TDA8425_Float* const taps[TDA8425_Tap_Count]
+)
+{
+    assert(self);
+    assert(data || !count);
+
+    if (self->blocks_dirty_) {
+        TDA8425_CYCLES_BEGIN(cycles);
+        TDA8425_Chip_SetupBlocks(self);
+        TDA8425_CYCLES_LAP(self, update_cycles, cycles);
+    }
+
+    TDA8425_Index index = 0;
+
+    for (; (count - index) >= TDA8425_BLOCK_SIZE; index += TDA8425_BLOCK_SIZE) {
+        TDA8425_Chip_ProcessBlockKernel(self, &data[index], taps, index);
+    }
+
+    if (self->recorder_) {
+        self->recorder_->frame_ += index;  // tail frames counted per frame
+    }
+
+    for (; index < count; ++index) {
+        TDA8425_Chip_ProcessTaps(self, &data[index], taps, index);  // tail
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+TDA8425_Register TDA8425_Chip_Read(
+    TDA8425_Chip const* self,
+    TDA8425_Address address
+)
+{
+    assert(self);
+
+    switch ((TDA8425_Reg)address)
+    {
+    case TDA8425_Reg_VL:
+        return self->reg_vl_ | (TDA8425_Register)~TDA8425_Volume_Data_Mask;
+
+    case TDA8425_Reg_VR:
+        return self->reg_vr_ | (TDA8425_Register)~TDA8425_Volume_Data_Mask;
+
+    case TDA8425_Reg_BA:
+        return self->reg_ba_ | (TDA8425_Register)~TDA8425_Tone_Data_Mask;
+
+    case TDA8425_Reg_TR:
+        return self->reg_tr_ | (TDA8425_Register)~TDA8425_Tone_Data_Mask;
+
+    case TDA8425_Reg_SF:
+        return self->reg_sf_ | (TDA8425_Register)~TDA8425_Switch_Data_Mask;
+
+    default:
+        return (TDA8425_Register)~0;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_Chip_WriteRegister(
+    TDA8425_Chip* self,
+    TDA8425_Address address,
+    TDA8425_Register data
+)
+{
+    assert(self);
+
+    switch ((TDA8425_Reg)address)
+    {
+    case TDA8425_Reg_VL: {
+        data |= (TDA8425_Register)~TDA8425_Volume_Data_Mask;
+        self->reg_vl_ = data;
+
+        if (self->reg_sf_ & (1 << TDA8425_Reg_SF_MU)) {
+            data = 0;
+        }
+        self->volume_[TDA8425_Stereo_L] = TDA8425_RegisterToVolume(data);
+        break;
+    }
+
+    case TDA8425_Reg_VR: {
+        data |= (TDA8425_Register)~TDA8425_Volume_Data_Mask;
+        self->reg_vr_ = data;
+
+        if (self->reg_sf_ & (1 << TDA8425_Reg_SF_MU)) {
+            data = 0;
+        }
+        self->volume_[TDA8425_Stereo_R] = TDA8425_RegisterToVolume(data);
+        break;
+    }
+
+    case TDA8425_Reg_BA: {
+        data |= (TDA8425_Register)~TDA8425_Tone_Data_Mask;
+        self->reg_ba_ = data;
+
+        TDA8425_Float bass_gain = TDA8425_RegisterToBass(data);
+
+        TDA8425_BiLinModel_SetupBass(
+            &self->bass_model_,
+            self->sample_rate_,
+            bass_gain
+        );
+        self->blocks_dirty_ |= TDA8425_BlockDirty_Bass;
+        TDA8425_COUNT(self, coefficient_updates, 1);
+
+        if (self->tfilter_mode_) {
+            TDA8425_BiQuadModel_SetupTfilter(
+                &self->tfilter_model_,
+                self->sample_rate_,
+                bass_gain
+            );
+            self->blocks_dirty_ |= TDA8425_BlockDirty_Tfilter;
+            TDA8425_COUNT(self, coefficient_updates, 1);
+        }
+        break;
+    }
+
+    case TDA8425_Reg_TR: {
+        data |= (TDA8425_Register)~TDA8425_Tone_Data_Mask;
+        self->reg_tr_ = data;
+
+        TDA8425_Float treble_gain = TDA8425_RegisterToTreble(data);
 
         TDA8425_BiLinModel_SetupTreble(
             &self->treble_model_,
             self->sample_rate_,
             treble_gain
         );
+        self->blocks_dirty_ |= TDA8425_BlockDirty_Treble;
+        TDA8425_COUNT(self, coefficient_updates, 1);
         break;
     }
 
@@ -964,6 +1713,8 @@ void TDA8425_Chip_Write(
             pseudo_c1,
             pseudo_c2
         );
+        self->blocks_dirty_ |= TDA8425_BlockDirty_Pseudo;
+        TDA8425_COUNT(self, coefficient_updates, 1);
         break;
     }
 #endif  // TDA8425_USE_EXTENSIONS
@@ -977,10 +1728,12 @@ void TDA8425_Chip_Write(
             & (TDA8425_Register)TDA8425_Selector_Mask
         );
 
-        self->mode_ = (TDA8425_Mode)(
+        TDA8425_Mode mode = (TDA8425_Mode)(
             (self->reg_sf_ >> TDA8425_Reg_SF_STL)
             & (TDA8425_Register)TDA8425_Mode_Mask
         );
+        TDA8425_COUNT(self, mode_switches, mode != self->mode_);
+        self->mode_ = mode;
 
 #if TDA8425_USE_EXTENSIONS
         self->dcremoval_mode_ = (TDA8425_DCRemoval_Mode)((
@@ -988,14 +1741,21 @@ void TDA8425_Chip_Write(
             & (TDA8425_Register)TDA8425_DCRemoval_Mode_Enabled
         ) ^ (TDA8425_Register)TDA8425_DCRemoval_Mode_Enabled);
 
+        TDA8425_Tfilter_Mode tfilter_mode = self->tfilter_mode_;
+
         self->tfilter_mode_ = (TDA8425_Tfilter_Mode)((
             (self->reg_sf_ >> TDA8425_Reg_SF_TF)
             & (TDA8425_Register)TDA8425_Tfilter_Mode_Enabled
         ) ^ (TDA8425_Register)TDA8425_Tfilter_Mode_Enabled);
+
+        if (self->tfilter_mode_ && !tfilter_mode) {
+            // T-filter model is only updated while enabled
+            TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_BA, self->reg_ba_);
+        }
 #endif  // TDA8425_USE_EXTENSIONS
 
-        TDA8425_Chip_Write(self, (TDA8425_Address)TDA8425_Reg_VL, self->reg_vl_);
-        TDA8425_Chip_Write(self, (TDA8425_Address)TDA8425_Reg_VR, self->reg_vr_);
+        TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_VL, self->reg_vl_);
+        TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_VR, self->reg_vr_);
         break;
     }
 
@@ -1003,3 +1763,1247 @@ void TDA8425_Chip_Write(
         break;
     }
 }
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_Write(
+    TDA8425_Chip* self,
+    TDA8425_Address address,
+    TDA8425_Register data
+)
+{
+    assert(self);
+
+    TDA8425_CYCLES_BEGIN(cycles);
+
+    if (self->recorder_) {
+        TDA8425_Recorder* recorder = self->recorder_;
+        TDA8425_WriteRecord* record = &recorder->records_[recorder->head_];
+        record->frame = recorder->frame_;
+        record->address = address;
+        record->data = data;
+
+        if (++recorder->head_ >= recorder->capacity_) {
+            recorder->head_ = 0;
+        }
+        if (recorder->count_ < recorder->capacity_) {
+            ++recorder->count_;
+        }
+        else {
+            ++recorder->dropped_;  // oldest overwritten
+        }
+    }
+
+    TDA8425_Chip_WriteRegister(self, address, data);
+
+#if TDA8425_USE_COUNTERS
+    switch ((TDA8425_Reg)address)
+    {
+    case TDA8425_Reg_VL: ++self->counters_.writes[TDA8425_RegOrder_VL]; break;
+    case TDA8425_Reg_VR: ++self->counters_.writes[TDA8425_RegOrder_VR]; break;
+    case TDA8425_Reg_BA: ++self->counters_.writes[TDA8425_RegOrder_BA]; break;
+    case TDA8425_Reg_TR: ++self->counters_.writes[TDA8425_RegOrder_TR]; break;
+    case TDA8425_Reg_PP: ++self->counters_.writes[TDA8425_RegOrder_PP]; break;
+    case TDA8425_Reg_SF: ++self->counters_.writes[TDA8425_RegOrder_SF]; break;
+    default: break;
+    }
+#endif  // TDA8425_USE_COUNTERS
+
+    TDA8425_CYCLES_LAP(self, write_cycles, cycles);
+}
+
+// ----------------------------------------------------------------------------
+
+bool TDA8425_Chip_GetCounters(
+    TDA8425_Chip const* self,
+    TDA8425_Counters* counters
+)
+{
+    (void)self;
+    assert(self);
+    assert(counters);
+
+#if TDA8425_USE_COUNTERS
+    // Lock-free copy while processing: each counter is loaded whole on 64-bit
+    // targets, but the counters are not mutually consistent
+    uint64_t const volatile* src = (uint64_t const volatile*)&self->counters_;
+    uint64_t* dst = (uint64_t*)counters;
+
+    for (size_t i = 0; i < (sizeof(TDA8425_Counters) / sizeof(uint64_t)); ++i) {
+        dst[i] = src[i];
+    }
+    return true;
+#else
+    memset(counters, 0, sizeof(TDA8425_Counters));
+    return false;
+#endif  // TDA8425_USE_COUNTERS
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_ResetCounters(TDA8425_Chip* self)
+{
+    (void)self;
+    assert(self);
+
+#if TDA8425_USE_COUNTERS
+    memset(&self->counters_, 0, sizeof(self->counters_));
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_SetRecorder(
+    TDA8425_Chip* self,
+    TDA8425_Recorder* recorder
+)
+{
+    assert(self);
+
+    self->recorder_ = recorder;
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_SetMeter(
+    TDA8425_Chip* self,
+    TDA8425_Meter* meter
+)
+{
+    assert(self);
+
+    self->meter_ = meter;
+}
+
+// ============================================================================
+
+void TDA8425_Meter_Reset(TDA8425_Meter* self)
+{
+    assert(self);
+
+    for (int channel = 0; channel < TDA8425_Stereo_Count; ++channel) {
+        self->peak[channel] = 0;
+        self->energy[channel] = 0;
+        self->clips[channel] = 0;
+        self->volume_peak[channel] = 0;
+        self->bass_peak[channel] = 0;
+    }
+    self->frames = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+TDA8425_Float TDA8425_Meter_GetRms(
+    TDA8425_Meter const* self,
+    TDA8425_Stereo channel
+)
+{
+    assert(self);
+
+    if (!self->frames) {
+        return 0;
+    }
+    return (TDA8425_Float)sqrt(self->energy[channel] / (TDA8425_Float)self->frames);
+}
+
+// ============================================================================
+
+void TDA8425_Recorder_Setup(
+    TDA8425_Recorder* self,
+    TDA8425_WriteRecord* records,
+    TDA8425_Index capacity
+)
+{
+    assert(self);
+    assert(records);
+    assert(capacity > 0);
+
+    self->records_ = records;
+    self->capacity_ = capacity;
+
+    TDA8425_Recorder_Reset(self, 0);
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Recorder_Reset(
+    TDA8425_Recorder* self,
+    uint64_t frame
+)
+{
+    assert(self);
+
+    self->head_ = 0;
+    self->count_ = 0;
+    self->frame_ = frame;
+    self->dropped_ = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+TDA8425_Index TDA8425_Recorder_Read(
+    TDA8425_Recorder const* self,
+    TDA8425_WriteRecord records[],
+    TDA8425_Index capacity
+)
+{
+    assert(self);
+    assert(records || !capacity);
+
+    // Oldest first
+    TDA8425_Index count = (capacity < self->count_) ? capacity : self->count_;
+    TDA8425_Index index = self->head_ + self->capacity_ - self->count_;
+    if (index >= self->capacity_) {
+        index -= self->capacity_;
+    }
+
+    for (TDA8425_Index i = 0; i < count; ++i) {
+        records[i] = self->records_[index];
+        if (++index >= self->capacity_) {
+            index = 0;
+        }
+    }
+    return count;
+}
+
+// ----------------------------------------------------------------------------
+
+uint64_t TDA8425_Recorder_GetDropped(TDA8425_Recorder const* self)
+{
+    assert(self);
+
+    return self->dropped_;
+}
+
+// ============================================================================
+
+//! Complex frequency response, one frequency per lane
+typedef struct TDA8425_ResponseBlock
+{
+    TDA8425_Float re[TDA8425_BLOCK_SIZE];
+    TDA8425_Float im[TDA8425_BLOCK_SIZE];
+
+    TDA8425_Float z1_re[TDA8425_BLOCK_SIZE];  // z^-1
+    TDA8425_Float z1_im[TDA8425_BLOCK_SIZE];
+    TDA8425_Float z2_re[TDA8425_BLOCK_SIZE];  // z^-2
+    TDA8425_Float z2_im[TDA8425_BLOCK_SIZE];
+} TDA8425_ResponseBlock;
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_ResponseBlock_Scale(
+    TDA8425_ResponseBlock* block,
+    TDA8425_Float gain
+)
+{
+    for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+        block->re[j] *= gain;
+        block->im[j] *= gain;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_ResponseBlock_MulBiQuad(
+    TDA8425_ResponseBlock* block,
+    TDA8425_BiQuadModel const* model
+)
+{
+    // H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 - a1 z^-1 - a2 z^-2), as per
+    // TDA8425_BiQuad_Process(); plain lane loops, so that they vectorize
+    TDA8425_Float const b0 = model->b0;
+    TDA8425_Float const b1 = model->b1;
+    TDA8425_Float const b2 = model->b2;
+    TDA8425_Float const a1 = model->a1;
+    TDA8425_Float const a2 = model->a2;
+
+    for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+        TDA8425_Float n_re = b0 + (b1 * block->z1_re[j]) + (b2 * block->z2_re[j]);
+        TDA8425_Float n_im = (b1 * block->z1_im[j]) + (b2 * block->z2_im[j]);
+        TDA8425_Float d_re = 1 - (a1 * block->z1_re[j]) - (a2 * block->z2_re[j]);
+        TDA8425_Float d_im = -(a1 * block->z1_im[j]) - (a2 * block->z2_im[j]);
+
+        TDA8425_Float t_re = (block->re[j] * n_re) - (block->im[j] * n_im);
+        TDA8425_Float t_im = (block->re[j] * n_im) + (block->im[j] * n_re);
+        TDA8425_Float d_norm = (d_re * d_re) + (d_im * d_im);
+
+        block->re[j] = ((t_re * d_re) + (t_im * d_im)) / d_norm;
+        block->im[j] = ((t_im * d_re) - (t_re * d_im)) / d_norm;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_ResponseBlock_MulBiLin(
+    TDA8425_ResponseBlock* block,
+    TDA8425_BiLinModel const* model
+)
+{
+    TDA8425_BiQuadModel biquad;
+    biquad.b0 = model->b0;
+    biquad.b1 = model->b1;
+    biquad.b2 = 0;
+    biquad.a1 = model->a1;
+    biquad.a2 = 0;
+
+    TDA8425_ResponseBlock_MulBiQuad(block, &biquad);
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_GetResponse(
+    TDA8425_Chip const* self,
+    TDA8425_Stereo channel,
+    TDA8425_Float const frequencies[],
+    TDA8425_Index count,
+    TDA8425_Float magnitudes[],
+    TDA8425_Float phases[]
+)
+{
+    assert(self);
+    assert(channel == TDA8425_Stereo_L || channel == TDA8425_Stereo_R);
+    assert(frequencies || !count);
+    assert(magnitudes || !count);
+
+    // Path from an input channel to the same output channel, with the other
+    // input channel silent
+    TDA8425_Float gain = self->volume_[channel];
+
+    if (self->mode_ == TDA8425_Mode_SpatialStereo) {
+        gain *= 1 + ((TDA8425_Float)TDA8425_Spatial_Crosstalk / 100);
+    }
+
+    TDA8425_Float const omega = (TDA8425_Float)(2 * M_PI) / self->sample_rate_;
+    TDA8425_ResponseBlock block;
+
+    for (TDA8425_Index index = 0; index < count; index += TDA8425_BLOCK_SIZE) {
+        TDA8425_Index lanes = count - index;
+        if (lanes > TDA8425_BLOCK_SIZE) {
+            lanes = TDA8425_BLOCK_SIZE;
+        }
+
+        for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+            TDA8425_Float w = ((TDA8425_Index)j < lanes) ? (omega * frequencies[index + (TDA8425_Index)j]) : 0;
+            block.z1_re[j] = (TDA8425_Float)cos(w);
+            block.z1_im[j] = (TDA8425_Float)-sin(w);
+        }
+        for (int j = 0; j < TDA8425_BLOCK_SIZE; ++j) {
+            block.z2_re[j] = (block.z1_re[j] * block.z1_re[j]) - (block.z1_im[j] * block.z1_im[j]);
+            block.z2_im[j] = 2 * block.z1_re[j] * block.z1_im[j];
+            block.re[j] = 1;
+            block.im[j] = 0;
+        }
+
+        if (self->dcremoval_mode_) {
+            TDA8425_ResponseBlock_MulBiLin(&block, &self->dcremoval_model_);
+        }
+        if (self->mode_ == TDA8425_Mode_PseudoStereo && channel == TDA8425_Stereo_L) {
+            TDA8425_ResponseBlock_MulBiQuad(&block, &self->pseudo_model_);
+        }
+        TDA8425_ResponseBlock_Scale(&block, gain);
+        TDA8425_ResponseBlock_MulBiLin(&block, &self->bass_model_);
+        TDA8425_ResponseBlock_MulBiLin(&block, &self->treble_model_);
+        if (self->tfilter_mode_ != TDA8425_Tfilter_Mode_Disabled) {
+            TDA8425_ResponseBlock_MulBiQuad(&block, &self->tfilter_model_);
+        }
+
+        for (TDA8425_Index j = 0; j < lanes; ++j) {
+            TDA8425_Float re = block.re[j];
+            TDA8425_Float im = block.im[j];
+            magnitudes[index + j] = (TDA8425_Float)sqrt((re * re) + (im * im));
+            if (phases) {
+                phases[index + j] = (TDA8425_Float)atan2(im, re);
+            }
+        }
+    }
+}
+
+// ============================================================================
+
+static void TDA8425_BiLinState_Get(
+    TDA8425_BiLinState const* state,
+    TDA8425_Float vector[2]
+)
+{
+    vector[0] = state->x0;
+    vector[1] = state->y0;
+}
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_BiLinState_Set(
+    TDA8425_BiLinState* state,
+    TDA8425_Float const vector[2]
+)
+{
+    state->x0 = vector[0];
+    state->y0 = vector[1];
+}
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_BiQuadState_Get(
+    TDA8425_BiQuadState const* state,
+    TDA8425_Float vector[4]
+)
+{
+    vector[0] = state->x0;
+    vector[1] = state->x1;
+    vector[2] = state->y0;
+    vector[3] = state->y1;
+}
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_BiQuadState_Set(
+    TDA8425_BiQuadState* state,
+    TDA8425_Float const vector[4]
+)
+{
+    state->x0 = vector[0];
+    state->x1 = vector[1];
+    state->y0 = vector[2];
+    state->y1 = vector[3];
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_GetState(
+    TDA8425_Chip const* self,
+    TDA8425_Float state[TDA8425_State_Count]
+)
+{
+    assert(self);
+    assert(state);
+
+    TDA8425_BiLinState_Get(&self->dcremoval_state_[TDA8425_Stereo_L], &state[TDA8425_State_DCRemoval_L]);
+    TDA8425_BiLinState_Get(&self->dcremoval_state_[TDA8425_Stereo_R], &state[TDA8425_State_DCRemoval_R]);
+    TDA8425_BiQuadState_Get(&self->pseudo_state_, &state[TDA8425_State_Pseudo]);
+    TDA8425_BiLinState_Get(&self->bass_state_[TDA8425_Stereo_L], &state[TDA8425_State_Bass_L]);
+    TDA8425_BiLinState_Get(&self->bass_state_[TDA8425_Stereo_R], &state[TDA8425_State_Bass_R]);
+    TDA8425_BiLinState_Get(&self->treble_state_[TDA8425_Stereo_L], &state[TDA8425_State_Treble_L]);
+    TDA8425_BiLinState_Get(&self->treble_state_[TDA8425_Stereo_R], &state[TDA8425_State_Treble_R]);
+    TDA8425_BiQuadState_Get(&self->tfilter_state_[TDA8425_Stereo_L], &state[TDA8425_State_Tfilter_L]);
+    TDA8425_BiQuadState_Get(&self->tfilter_state_[TDA8425_Stereo_R], &state[TDA8425_State_Tfilter_R]);
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_SetState(
+    TDA8425_Chip* self,
+    TDA8425_Float const state[TDA8425_State_Count]
+)
+{
+    assert(self);
+    assert(state);
+
+    TDA8425_BiLinState_Set(&self->dcremoval_state_[TDA8425_Stereo_L], &state[TDA8425_State_DCRemoval_L]);
+    TDA8425_BiLinState_Set(&self->dcremoval_state_[TDA8425_Stereo_R], &state[TDA8425_State_DCRemoval_R]);
+    TDA8425_BiQuadState_Set(&self->pseudo_state_, &state[TDA8425_State_Pseudo]);
+    TDA8425_BiLinState_Set(&self->bass_state_[TDA8425_Stereo_L], &state[TDA8425_State_Bass_L]);
+    TDA8425_BiLinState_Set(&self->bass_state_[TDA8425_Stereo_R], &state[TDA8425_State_Bass_R]);
+    TDA8425_BiLinState_Set(&self->treble_state_[TDA8425_Stereo_L], &state[TDA8425_State_Treble_L]);
+    TDA8425_BiLinState_Set(&self->treble_state_[TDA8425_Stereo_R], &state[TDA8425_State_Treble_R]);
+    TDA8425_BiQuadState_Set(&self->tfilter_state_[TDA8425_Stereo_L], &state[TDA8425_State_Tfilter_L]);
+    TDA8425_BiQuadState_Set(&self->tfilter_state_[TDA8425_Stereo_R], &state[TDA8425_State_Tfilter_R]);
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_SaveSnapshot(
+    TDA8425_Chip const* self,
+    TDA8425_ChipSnapshot* snapshot
+)
+{
+    assert(self);
+    assert(snapshot);
+
+    snapshot->tag = TDA8425_SNAPSHOT_TAG;
+
+    snapshot->regs[TDA8425_RegOrder_VL] = self->reg_vl_;
+    snapshot->regs[TDA8425_RegOrder_VR] = self->reg_vr_;
+    snapshot->regs[TDA8425_RegOrder_BA] = self->reg_ba_;
+    snapshot->regs[TDA8425_RegOrder_TR] = self->reg_tr_;
+    snapshot->regs[TDA8425_RegOrder_PP] = self->reg_pp_;
+    snapshot->regs[TDA8425_RegOrder_SF] = self->reg_sf_;
+    memset(snapshot->reserved_, 0, sizeof(snapshot->reserved_));
+
+    TDA8425_Chip_GetState(self, snapshot->state);
+}
+
+// ----------------------------------------------------------------------------
+
+bool TDA8425_Chip_LoadSnapshot(
+    TDA8425_Chip* self,
+    TDA8425_ChipSnapshot const* snapshot
+)
+{
+    assert(self);
+    assert(snapshot);
+
+    if (snapshot->tag != TDA8425_SNAPSHOT_TAG) {
+        return false;
+    }
+
+    // Rebuild coefficients only for changed registers; SF goes first, as it
+    // refreshes volumes and T-filter
+    TDA8425_Register const* regs = snapshot->regs;
+
+    if (self->reg_sf_ != regs[TDA8425_RegOrder_SF]) {
+        TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_SF, regs[TDA8425_RegOrder_SF]);
+    }
+    if (self->reg_vl_ != regs[TDA8425_RegOrder_VL]) {
+        TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_VL, regs[TDA8425_RegOrder_VL]);
+    }
+    if (self->reg_vr_ != regs[TDA8425_RegOrder_VR]) {
+        TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_VR, regs[TDA8425_RegOrder_VR]);
+    }
+    if (self->reg_ba_ != regs[TDA8425_RegOrder_BA]) {
+        TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_BA, regs[TDA8425_RegOrder_BA]);
+    }
+    if (self->reg_tr_ != regs[TDA8425_RegOrder_TR]) {
+        TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_TR, regs[TDA8425_RegOrder_TR]);
+    }
+    if (self->reg_pp_ != regs[TDA8425_RegOrder_PP]) {
+        TDA8425_Chip_WriteRegister(self, (TDA8425_Address)TDA8425_Reg_PP, regs[TDA8425_RegOrder_PP]);
+    }
+
+    TDA8425_Chip_SetState(self, snapshot->state);
+    return true;
+}
+
+// ============================================================================
+
+void TDA8425_SnapshotRing_Setup(
+    TDA8425_SnapshotRing* self,
+    TDA8425_SnapshotEntry* entries,
+    TDA8425_Index capacity,
+    TDA8425_Index interval
+)
+{
+    assert(self);
+    assert(entries);
+    assert(capacity > 0);
+    assert(interval > 0);
+
+    self->entries_ = entries;
+    self->capacity_ = capacity;
+    self->interval_ = interval;
+
+    TDA8425_SnapshotRing_Reset(self, 0);
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_SnapshotRing_Reset(
+    TDA8425_SnapshotRing* self,
+    TDA8425_Index frame
+)
+{
+    assert(self);
+
+    self->head_ = 0;
+    self->count_ = 0;
+    self->next_frame_ = frame;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TDA8425_SnapshotRing_Capture(
+    TDA8425_SnapshotRing* self,
+    TDA8425_Chip const* chip,
+    TDA8425_Index frame
+)
+{
+    assert(self);
+    assert(chip);
+
+    if (frame < self->next_frame_) {
+        return false;
+    }
+
+    // A late capture point is taken at the current frame, keeping the history
+    TDA8425_SnapshotEntry* entry = &self->entries_[self->head_];
+    entry->frame = frame;
+    TDA8425_Chip_SaveSnapshot(chip, &entry->snapshot);
+
+    if (++self->head_ >= self->capacity_) {
+        self->head_ = 0;
+    }
+
+    if (self->count_ < self->capacity_) {
+        ++self->count_;  // else oldest overwritten
+    }
+
+    self->next_frame_ = frame + self->interval_;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TDA8425_SnapshotRing_Restore(
+    TDA8425_SnapshotRing* self,
+    TDA8425_Chip* chip,
+    TDA8425_Index frame,
+    TDA8425_Index* restored_frame
+)
+{
+    assert(self);
+    assert(chip);
+
+    if (!self->count_) {
+        return false;
+    }
+
+    // Frames increase from the oldest entry, so binary search the latest one
+    // not newer than the requested frame
+    TDA8425_Index oldest = self->head_ + self->capacity_ - self->count_;
+    TDA8425_Index low = 0;
+    TDA8425_Index high = self->count_;
+
+    while (low < high) {
+        TDA8425_Index middle = low + ((high - low) / 2);
+        TDA8425_Index index = (oldest + middle) % self->capacity_;
+
+        if (self->entries_[index].frame <= frame) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    if (!low) {
+        return false;  // older than the whole history
+    }
+
+    TDA8425_Index offset = low - 1;
+    TDA8425_Index index = (oldest + offset) % self->capacity_;
+    TDA8425_SnapshotEntry const* entry = &self->entries_[index];
+
+    if (!TDA8425_Chip_LoadSnapshot(chip, &entry->snapshot)) {
+        return false;
+    }
+
+    // Newer snapshots belong to the discarded timeline
+    TDA8425_Index frame_found = entry->frame;
+    self->count_ = offset + 1;
+    self->head_ = index + 1;
+    if (self->head_ >= self->capacity_) {
+        self->head_ = 0;
+    }
+    self->next_frame_ = frame_found + self->interval_;
+
+    if (restored_frame) {
+        *restored_frame = frame_found;
+    }
+    return true;
+}
+
+// ============================================================================
+
+typedef TDA8425_Float TDA8425_StateMatrix[TDA8425_State_Count][TDA8425_State_Count];
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_StateMatrix_Multiply(
+    TDA8425_Float const a[TDA8425_State_Count][TDA8425_State_Count],
+    TDA8425_Float const b[TDA8425_State_Count][TDA8425_State_Count],
+    TDA8425_Float result[TDA8425_State_Count][TDA8425_State_Count]
+)
+{
+    for (int i = 0; i < TDA8425_State_Count; ++i) {
+        for (int j = 0; j < TDA8425_State_Count; ++j) {
+            result[i][j] = 0;
+        }
+        for (int k = 0; k < TDA8425_State_Count; ++k) {
+            TDA8425_Float aik = a[i][k];
+            for (int j = 0; j < TDA8425_State_Count; ++j) {
+                result[i][j] += aik * b[k][j];
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_GetTransition(
+    TDA8425_Chip const* self,
+    TDA8425_Index frames,
+    TDA8425_Float matrix[TDA8425_State_Count][TDA8425_State_Count]
+)
+{
+    assert(self);
+    assert(matrix);
+
+    // All filters are linear, so each column of the one-frame transition is
+    // the zero-input response to a basis state
+    TDA8425_Chip chip = *self;
+    TDA8425_StateMatrix step;
+    TDA8425_Float state[TDA8425_State_Count];
+    chip.recorder_ = NULL;
+    chip.meter_ = NULL;
+
+    for (int j = 0; j < TDA8425_State_Count; ++j) {
+        TDA8425_Float stereo[TDA8425_Stereo_Count] = { 0, 0 };
+        TDA8425_Float outputs[TDA8425_Stereo_Count];
+
+        for (int i = 0; i < TDA8425_State_Count; ++i) {
+            state[i] = (TDA8425_Float)(i == j);
+        }
+        TDA8425_Chip_SetState(&chip, state);
+        TDA8425_Chip_ProcessStereo(&chip, stereo, outputs);
+        TDA8425_Chip_GetState(&chip, state);
+
+        for (int i = 0; i < TDA8425_State_Count; ++i) {
+            step[i][j] = state[i];
+        }
+    }
+
+    // Exponentiation by squaring
+    TDA8425_StateMatrix temp;
+    for (int i = 0; i < TDA8425_State_Count; ++i) {
+        for (int j = 0; j < TDA8425_State_Count; ++j) {
+            matrix[i][j] = (TDA8425_Float)(i == j);
+        }
+    }
+
+    while (frames) {
+        if (frames & 1) {
+            TDA8425_StateMatrix_Multiply(
+                (TDA8425_Float const (*)[TDA8425_State_Count])matrix,
+                (TDA8425_Float const (*)[TDA8425_State_Count])step,
+                temp
+            );
+            memcpy(matrix, temp, sizeof(temp));
+        }
+        frames >>= 1;
+        if (frames) {
+            TDA8425_StateMatrix_Multiply(
+                (TDA8425_Float const (*)[TDA8425_State_Count])step,
+                (TDA8425_Float const (*)[TDA8425_State_Count])step,
+                temp
+            );
+            memcpy(step, temp, sizeof(temp));
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_State_Propagate(
+    TDA8425_Float const matrix[TDA8425_State_Count][TDA8425_State_Count],
+    TDA8425_Float const initial[TDA8425_State_Count],
+    TDA8425_Float const forced[TDA8425_State_Count],
+    TDA8425_Float result[TDA8425_State_Count]
+)
+{
+    assert(matrix);
+    assert(initial);
+    assert(forced);
+    assert(result);
+    assert(result != initial);
+
+    for (int i = 0; i < TDA8425_State_Count; ++i) {
+        TDA8425_Float sum = forced[i];
+        for (int j = 0; j < TDA8425_State_Count; ++j) {
+            sum += matrix[i][j] * initial[j];
+        }
+        result[i] = sum;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+typedef struct TDA8425_ChunkedJob
+{
+    TDA8425_Chip const* chip;
+    TDA8425_Chip_Process_Data* data;
+    TDA8425_Index count;
+    TDA8425_Index chunk_length;
+    TDA8425_Float (*states)[TDA8425_State_Count];
+} TDA8425_ChunkedJob;
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_Chip_ZeroStateTask(void* arg, TDA8425_Index index)
+{
+    // Renders the chunk from zero state, and keeps its final state
+    TDA8425_ChunkedJob const* job = (TDA8425_ChunkedJob const*)arg;
+    TDA8425_Index begin = index * job->chunk_length;
+    TDA8425_Index end = begin + job->chunk_length;
+    if (end > job->count) {
+        end = job->count;
+    }
+
+    TDA8425_Chip chip = *job->chip;
+    TDA8425_Float* state = job->states[index];
+    chip.recorder_ = NULL;  // frames are counted by the caller
+    chip.meter_ = NULL;     // partial outputs
+
+    for (int i = 0; i < TDA8425_State_Count; ++i) {
+        state[i] = 0;
+    }
+    TDA8425_Chip_SetState(&chip, state);
+
+    TDA8425_Chip_ProcessBlock(&chip, &job->data[begin], end - begin);
+    TDA8425_Chip_GetState(&chip, state);
+}
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_Chip_ZeroInputTask(void* arg, TDA8425_Index index)
+{
+    // Adds the response to the actual initial state of the chunk
+    TDA8425_ChunkedJob const* job = (TDA8425_ChunkedJob const*)arg;
+    TDA8425_Index begin = index * job->chunk_length;
+    TDA8425_Index end = begin + job->chunk_length;
+    if (end > job->count) {
+        end = job->count;
+    }
+
+    TDA8425_Chip chip = *job->chip;
+    chip.recorder_ = NULL;  // frames are counted by the caller
+    chip.meter_ = NULL;     // partial outputs
+    TDA8425_Chip_SetState(&chip, job->states[index]);
+
+    for (TDA8425_Index k = begin; k < end; ++k) {
+        TDA8425_Float stereo[TDA8425_Stereo_Count] = { 0, 0 };
+        TDA8425_Float outputs[TDA8425_Stereo_Count];
+        TDA8425_Float* data_outputs = job->data[k].outputs;
+
+        TDA8425_Chip_ProcessStereo(&chip, stereo, outputs);
+        data_outputs[TDA8425_Stereo_L] += outputs[TDA8425_Stereo_L];
+        data_outputs[TDA8425_Stereo_R] += outputs[TDA8425_Stereo_R];
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+bool TDA8425_Chip_ProcessChunked(
+    TDA8425_Chip* self,
+    TDA8425_Chip_Process_Data data[],
+    TDA8425_Index count,
+    TDA8425_Index chunk_count,
+    TDA8425_ForEach for_each,
+    void* context
+)
+{
+    assert(self);
+    assert(data || !count);
+    assert(chunk_count > 0);
+
+    if (!count) {
+        return true;
+    }
+    if (chunk_count > count) {
+        chunk_count = count;
+    }
+
+    TDA8425_Index chunk_length = (count + chunk_count - 1) / chunk_count;
+    chunk_count = (count + chunk_length - 1) / chunk_length;
+    TDA8425_Index last_length = count - ((chunk_count - 1) * chunk_length);
+
+    TDA8425_Float (*states)[TDA8425_State_Count];
+    states = (TDA8425_Float (*)[TDA8425_State_Count])malloc(
+        sizeof(*states) * (chunk_count + 1)
+    );
+    TDA8425_Float (*matrices)[TDA8425_State_Count][TDA8425_State_Count];
+    matrices = (TDA8425_Float (*)[TDA8425_State_Count][TDA8425_State_Count])malloc(
+        sizeof(*matrices) * 2
+    );
+    if (!states || !matrices) {
+        free(states);
+        free(matrices);
+        return false;
+    }
+
+    TDA8425_CYCLES_BEGIN(cycles);
+    TDA8425_COUNT(self, frames, count);
+
+    if (self->recorder_) {
+        self->recorder_->frame_ += count;
+    }
+
+    if (self->blocks_dirty_) {
+        TDA8425_Chip_SetupBlocks(self);  // once for all the workers
+        TDA8425_CYCLES_LAP(self, update_cycles, cycles);
+    }
+
+    TDA8425_ChunkedJob job;
+    job.chip = self;
+    job.data = data;
+    job.count = count;
+    job.chunk_length = chunk_length;
+    job.states = states;
+
+    // Pass 1: zero-state responses, all chunks in parallel
+    if (for_each) {
+        for_each(context, TDA8425_Chip_ZeroStateTask, &job, chunk_count);
+    }
+    else {
+        for (TDA8425_Index index = 0; index < chunk_count; ++index) {
+            TDA8425_Chip_ZeroStateTask(&job, index);
+        }
+    }
+
+    // Chain chunk boundaries: s[i+1] = A^L * s[i] + z[i]
+    TDA8425_Chip_GetTransition(self, chunk_length, matrices[0]);
+    TDA8425_Chip_GetTransition(self, last_length, matrices[1]);
+
+    TDA8425_Float initial[TDA8425_State_Count];
+    TDA8425_Chip_GetState(self, initial);
+
+    for (TDA8425_Index index = 0; index < chunk_count; ++index) {
+        TDA8425_Float forced[TDA8425_State_Count];
+        for (int i = 0; i < TDA8425_State_Count; ++i) {
+            forced[i] = states[index][i];
+            states[index][i] = initial[i];
+        }
+        TDA8425_State_Propagate(
+            (TDA8425_Float const (*)[TDA8425_State_Count])
+                matrices[(index + 1 < chunk_count) ? 0 : 1],
+            initial,
+            forced,
+            states[chunk_count]
+        );
+        for (int i = 0; i < TDA8425_State_Count; ++i) {
+            initial[i] = states[chunk_count][i];
+        }
+    }
+    TDA8425_Chip_SetState(self, initial);
+
+    // Pass 2: zero-input responses, all chunks in parallel
+    if (for_each) {
+        for_each(context, TDA8425_Chip_ZeroInputTask, &job, chunk_count);
+    }
+    else {
+        for (TDA8425_Index index = 0; index < chunk_count; ++index) {
+            TDA8425_Chip_ZeroInputTask(&job, index);
+        }
+    }
+
+    free(states);
+    free(matrices);
+
+    if (self->meter_) {
+        // Outputs only, as the chunks sum partial responses
+        TDA8425_Meter* meter = self->meter_;
+        for (TDA8425_Index k = 0; k < count; ++k) {
+            TDA8425_Meter_UpdateOutput(meter, TDA8425_Stereo_L, &data[k].outputs[TDA8425_Stereo_L], 1);
+            TDA8425_Meter_UpdateOutput(meter, TDA8425_Stereo_R, &data[k].outputs[TDA8425_Stereo_R], 1);
+        }
+        meter->frames += count;
+    }
+    TDA8425_CYCLES_LAP(self, chunked_cycles, cycles);
+    return true;
+}
+
+// ============================================================================
+
+#define TDA8425_RESAMPLER_ONE ((uint64_t)1 << 32)
+
+static unsigned const TDA8425_Resampler_Taps_Table[TDA8425_Resampler_Quality_Count] =
+{
+    16,
+    32,
+    64
+};
+
+static double const TDA8425_Resampler_Cutoff_Table[TDA8425_Resampler_Quality_Count] =
+{
+    0.40,
+    0.45,
+    0.475
+};
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Resampler_Ctor(TDA8425_Resampler* self)
+{
+    assert(self);
+
+    self->table_ = NULL;
+    self->taps_ = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Resampler_Dtor(TDA8425_Resampler* self)
+{
+    assert(self);
+
+    free(self->table_);
+    self->table_ = NULL;
+    self->taps_ = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TDA8425_Resampler_Setup(
+    TDA8425_Resampler* self,
+    TDA8425_Float input_rate,
+    TDA8425_Float output_rate,
+    TDA8425_Resampler_Quality quality
+)
+{
+    assert(self);
+    assert(input_rate > 0);
+    assert(output_rate > 0);
+    assert((unsigned)quality < (unsigned)TDA8425_Resampler_Quality_Count);
+
+    unsigned taps = TDA8425_Resampler_Taps_Table[quality];
+    assert(taps <= TDA8425_Resampler_Max_Taps);
+    assert(!(taps % 4));
+
+    if (!self->table_ || self->taps_ < taps) {
+        free(self->table_);
+        self->table_ = (TDA8425_Float*)malloc(
+            sizeof(TDA8425_Float) * taps * (TDA8425_Resampler_Phases + 1)
+        );
+        if (!self->table_) {
+            self->taps_ = 0;
+            return false;
+        }
+    }
+
+    self->input_rate_ = input_rate;
+    self->output_rate_ = output_rate;
+    self->quality_ = quality;
+    self->taps_ = taps;
+
+    double ratio = (double)input_rate / (double)output_rate;
+    self->step_ = (uint64_t)(ratio * (double)TDA8425_RESAMPLER_ONE + 0.5);
+
+    // Windowed sinc, band-limited to the lower of the two Nyquist rates
+    double fc = TDA8425_Resampler_Cutoff_Table[quality];
+    if (ratio > 1) {
+        fc /= ratio;
+    }
+    double half = (double)taps * 0.5;
+
+    for (unsigned p = 0; p <= TDA8425_Resampler_Phases; ++p) {
+        TDA8425_Float* row = &self->table_[p * taps];
+        double frac = (double)p / (double)TDA8425_Resampler_Phases;
+        double sum = 0;
+
+        for (unsigned k = 0; k < taps; ++k) {
+            double t = ((double)k - half) + frac;
+            double x = (2 * M_PI) * fc * t;
+            double sinc = (x != 0) ? (sin(x) / x) : 1;
+            double u = (2 * M_PI) * (t / (double)taps);
+            double window = 0.42 + (0.5 * cos(u)) + (0.08 * cos(2 * u));
+            double h = (2 * fc) * sinc * window;
+            row[k] = (TDA8425_Float)h;
+            sum += h;
+        }
+
+        double rsum = 1 / sum;
+        for (unsigned k = 0; k < taps; ++k) {
+            row[k] = (TDA8425_Float)(row[k] * rsum);
+        }
+    }
+
+    TDA8425_Resampler_Reset(self);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Resampler_Reset(TDA8425_Resampler* self)
+{
+    assert(self);
+
+    self->phase_ = 0;
+    self->position_ = 0;
+
+    for (int c = 0; c < TDA8425_Stereo_Count; ++c) {
+        for (unsigned k = 0; k < TDA8425_Resampler_Max_Taps * 2; ++k) {
+            self->history_[c][k] = 0;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+TDA8425_Float TDA8425_Resampler_GetChipRate(
+    TDA8425_Resampler const* self
+)
+{
+    assert(self);
+
+    // Filters run at the lower rate, which is the cheaper one
+    if (self->input_rate_ < self->output_rate_) {
+        return self->input_rate_;
+    }
+    else {
+        return self->output_rate_;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+TDA8425_Index TDA8425_Resampler_GetMaxOutputs(
+    TDA8425_Resampler const* self,
+    TDA8425_Index input_count
+)
+{
+    assert(self);
+    assert(self->step_);
+
+    uint64_t span = ((uint64_t)input_count * TDA8425_RESAMPLER_ONE) + TDA8425_RESAMPLER_ONE;
+    return (TDA8425_Index)(span / self->step_) + 1;
+}
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_Resampler_Push(
+    TDA8425_Resampler* self,
+    TDA8425_Float const stereo[TDA8425_Stereo_Count]
+)
+{
+    // History is mirrored, so that each dot product reads a contiguous span
+    unsigned taps = self->taps_;
+    unsigned position = self->position_;
+    position = (position ? position : taps) - 1;
+    self->position_ = position;
+
+    for (int c = 0; c < TDA8425_Stereo_Count; ++c) {
+        self->history_[c][position] = stereo[c];
+        self->history_[c][position + taps] = stereo[c];
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static TDA8425_Float TDA8425_Resampler_Dot(
+    TDA8425_Float const* a,
+    TDA8425_Float const* b,
+    unsigned taps
+)
+{
+    // Independent accumulators let the compiler map lanes to SIMD registers
+    TDA8425_Float acc0 = 0;
+    TDA8425_Float acc1 = 0;
+    TDA8425_Float acc2 = 0;
+    TDA8425_Float acc3 = 0;
+
+    for (unsigned k = 0; k < taps; k += 4) {
+        acc0 += a[k + 0] * b[k + 0];
+        acc1 += a[k + 1] * b[k + 1];
+        acc2 += a[k + 2] * b[k + 2];
+        acc3 += a[k + 3] * b[k + 3];
+    }
+    return (acc0 + acc2) + (acc1 + acc3);
+}
+
+// ----------------------------------------------------------------------------
+
+static void TDA8425_Resampler_Pop(
+    TDA8425_Resampler* self,
+    TDA8425_Float stereo[TDA8425_Stereo_Count]
+)
+{
+    unsigned taps = self->taps_;
+    uint32_t phase = (uint32_t)self->phase_;
+    unsigned p = (unsigned)(phase >> 24);  // TDA8425_Resampler_Phases == 1 << 8
+    TDA8425_Float frac = (TDA8425_Float)(phase & 0x00FFFFFFu) * (TDA8425_Float)(1. / 16777216.);
+    TDA8425_Float const* row0 = &self->table_[p * taps];
+    TDA8425_Float const* row1 = row0 + taps;
+
+    for (int c = 0; c < TDA8425_Stereo_Count; ++c) {
+        TDA8425_Float const* x = &self->history_[c][self->position_];
+        TDA8425_Float y0 = TDA8425_Resampler_Dot(row0, x, taps);
+        TDA8425_Float y1 = TDA8425_Resampler_Dot(row1, x, taps);
+        stereo[c] = y0 + ((y1 - y0) * frac);
+    }
+
+    self->phase_ += self->step_;
+}
+
+// ----------------------------------------------------------------------------
+
+TDA8425_Index TDA8425_Resampler_Process(
+    TDA8425_Resampler* self,
+    TDA8425_Float const inputs[][TDA8425_Stereo_Count],
+    TDA8425_Index input_count,
+    TDA8425_Float outputs[][TDA8425_Stereo_Count],
+    TDA8425_Index output_capacity
+)
+{
+    assert(self);
+    assert(self->table_);
+    assert(inputs || !input_count);
+    assert(outputs || !output_capacity);
+    assert(output_capacity >= TDA8425_Resampler_GetMaxOutputs(self, input_count));
+    (void)output_capacity;
+
+    TDA8425_Index output_count = 0;
+
+    for (TDA8425_Index i = 0; i < input_count; ++i) {
+        TDA8425_Resampler_Push(self, inputs[i]);
+
+        while (self->phase_ < TDA8425_RESAMPLER_ONE) {
+            TDA8425_Resampler_Pop(self, outputs[output_count++]);
+        }
+        self->phase_ -= TDA8425_RESAMPLER_ONE;
+    }
+    return output_count;
+}
+
+// ----------------------------------------------------------------------------
+
+TDA8425_Index TDA8425_Chip_ProcessResampled(
+    TDA8425_Chip* self,
+    TDA8425_Resampler* resampler,
+    TDA8425_Float const inputs[][TDA8425_Source_Count][TDA8425_Stereo_Count],
+    TDA8425_Index input_count,
+    TDA8425_Float outputs[][TDA8425_Stereo_Count],
+    TDA8425_Index output_capacity
+)
+{
+    assert(self);
+    assert(resampler);
+    assert(resampler->table_);
+    assert(inputs || !input_count);
+    assert(outputs || !output_capacity);
+    assert(output_capacity >= TDA8425_Resampler_GetMaxOutputs(resampler, input_count));
+    assert(self->sample_rate_ == TDA8425_Resampler_GetChipRate(resampler));
+    (void)output_capacity;
+
+    TDA8425_Index output_count = 0;
+    TDA8425_Float stereo[TDA8425_Stereo_Count];
+
+    if (resampler->input_rate_ < resampler->output_rate_) {
+        // Upsampling: chip filters at the input rate
+        for (TDA8425_Index i = 0; i < input_count; ++i) {
+            TDA8425_Float processed[TDA8425_Stereo_Count];
+            TDA8425_Chip_ProcessSelector(self, inputs[i], stereo);
+            TDA8425_Chip_ProcessStereo(self, stereo, processed);
+            TDA8425_Resampler_Push(resampler, processed);
+
+            while (resampler->phase_ < TDA8425_RESAMPLER_ONE) {
+                TDA8425_Resampler_Pop(resampler, outputs[output_count++]);
+            }
+            resampler->phase_ -= TDA8425_RESAMPLER_ONE;
+        }
+    }
+    else {
+        // Downsampling: chip filters at the output rate
+        for (TDA8425_Index i = 0; i < input_count; ++i) {
+            TDA8425_Chip_ProcessSelector(self, inputs[i], stereo);
+            TDA8425_Resampler_Push(resampler, stereo);
+
+            while (resampler->phase_ < TDA8425_RESAMPLER_ONE) {
+                TDA8425_Resampler_Pop(resampler, stereo);
+                TDA8425_Chip_ProcessStereo(self, stereo, outputs[output_count++]);
+            }
+            resampler->phase_ -= TDA8425_RESAMPLER_ONE;
+        }
+    }
+
+    if (self->recorder_) {
+        // Frames at the chip rate
+        self->recorder_->frame_ += (resampler->input_rate_ < resampler->output_rate_) ? input_count : output_count;
+    }
+    return output_count;
+}
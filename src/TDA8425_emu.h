@@ -46,6 +46,14 @@ extern "C" {
 #define TDA8425_USE_EXTENSIONS 1
 #endif
 
+#ifndef TDA8425_BLOCK_SIZE
+#define TDA8425_BLOCK_SIZE 8            //!< Frames per block kernel step
+#endif
+
+#ifndef TDA8425_USE_COUNTERS
+#define TDA8425_USE_COUNTERS 0          //!< Hot-path counters: 0 = none, 1 = events, 2 = events and cycles
+#endif
+
 // ============================================================================
 
 #define TDA8425_VERSION "0.2.0"
@@ -329,6 +337,50 @@ TDA8425_Float TDA8425_BiLin_Process(
 
 // ============================================================================
 
+//! Bi-Quad block state-space model
+typedef struct TDA8425_BiQuadBlock
+{
+    TDA8425_Float impulse[TDA8425_BLOCK_SIZE][TDA8425_BLOCK_SIZE];  //!< [input][output]
+    TDA8425_Float state[4][TDA8425_BLOCK_SIZE];  //!< [x0, x1, y0, y1][output]
+} TDA8425_BiQuadBlock;
+
+//! Bi-Lin block state-space model
+typedef struct TDA8425_BiLinBlock
+{
+    TDA8425_Float impulse[TDA8425_BLOCK_SIZE][TDA8425_BLOCK_SIZE];  //!< [input][output]
+    TDA8425_Float state[2][TDA8425_BLOCK_SIZE];  //!< [x0, y0][output]
+} TDA8425_BiLinBlock;
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_BiQuadBlock_Setup(
+    TDA8425_BiQuadBlock* block,
+    TDA8425_BiQuadModel const* model
+);
+
+void TDA8425_BiQuadBlock_Process(
+    TDA8425_BiQuadBlock const* block,
+    TDA8425_BiQuadState* state,
+    TDA8425_Float const inputs[TDA8425_BLOCK_SIZE],
+    TDA8425_Float outputs[TDA8425_BLOCK_SIZE]
+);
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_BiLinBlock_Setup(
+    TDA8425_BiLinBlock* block,
+    TDA8425_BiLinModel const* model
+);
+
+void TDA8425_BiLinBlock_Process(
+    TDA8425_BiLinBlock const* block,
+    TDA8425_BiLinState* state,
+    TDA8425_Float const inputs[TDA8425_BLOCK_SIZE],
+    TDA8425_Float outputs[TDA8425_BLOCK_SIZE]
+);
+
+// ============================================================================
+
 void TDA8425_DCRemoval_Process(
     TDA8425_Float stereo[TDA8425_Stereo_Count],
     TDA8425_BiLinModel const* model,
@@ -357,6 +409,72 @@ void TDA8425_SpatialStereo_Process(
 
 // ============================================================================
 
+//! Processing stages, as per hot-path counters
+typedef enum TDA8425_Stage {
+    TDA8425_Stage_Selector  = 0,
+    TDA8425_Stage_DCRemoval = 1,
+    TDA8425_Stage_Mode      = 2,
+    TDA8425_Stage_Tone      = 3,  //!< Volume, bass, and treble
+    TDA8425_Stage_Tfilter   = 4,
+    TDA8425_Stage_Count     = 5
+} TDA8425_Stage;
+
+//! Hot-path counters, enabled by TDA8425_USE_COUNTERS
+typedef struct TDA8425_Counters
+{
+    uint64_t frames;                              //!< Processed frames
+    uint64_t block_frames;                        //!< Frames processed by block kernels
+    uint64_t writes[TDA8425_RegOrder_Count];      //!< TDA8425_Chip_Write() calls
+    uint64_t coefficient_updates;                 //!< Filter model recomputations
+    uint64_t block_updates;                       //!< Block model recomputations
+    uint64_t mode_switches;                       //!< Stereo mode changes
+    uint64_t idle_frames;                         //!< Frames processed while muted
+    uint64_t bypass_frames[TDA8425_Stage_Count];  //!< Frames skipping a stage
+    uint64_t stage_cycles[TDA8425_Stage_Count];   //!< Cycles per stage
+    uint64_t write_cycles;                        //!< Cycles of register writes
+    uint64_t update_cycles;                       //!< Cycles of block model recomputations
+    uint64_t chunked_cycles;                      //!< Cycles of chunked processing
+} TDA8425_Counters;
+
+// ============================================================================
+
+//! Recorded register write
+typedef struct TDA8425_WriteRecord
+{
+    uint64_t frame;            //!< Frames processed before the write
+    TDA8425_Address address;   //!< Register address
+    TDA8425_Register data;     //!< Register value
+} TDA8425_WriteRecord;
+
+//! Register write trace recorder, into a caller-provided ring.
+//! Only TDA8425_Chip_Write() calls are recorded, not resets nor snapshot loads.
+typedef struct TDA8425_Recorder
+{
+    TDA8425_WriteRecord* records_;
+    TDA8425_Index capacity_;
+    TDA8425_Index head_;
+    TDA8425_Index count_;
+    uint64_t frame_;
+    uint64_t dropped_;
+} TDA8425_Recorder;
+
+//! Output meter, fused into processing.
+//! TDA8425_Chip_ProcessChunked() meters the outputs only, leaving the volume
+//! and bass peaks unchanged.
+//! TDA8425_Chip_ProcessResampled() meters the chip outputs at the chip rate,
+//! so before the resampler when upsampling.
+typedef struct TDA8425_Meter
+{
+    TDA8425_Float peak[TDA8425_Stereo_Count];         //!< Output peak magnitude
+    TDA8425_Float energy[TDA8425_Stereo_Count];       //!< Output sum of squares
+    uint64_t clips[TDA8425_Stereo_Count];             //!< Output samples beyond +/-1
+    TDA8425_Float volume_peak[TDA8425_Stereo_Count];  //!< Peak magnitude after volume
+    TDA8425_Float bass_peak[TDA8425_Stereo_Count];    //!< Peak magnitude after bass
+    uint64_t frames;                                  //!< Metered frames
+} TDA8425_Meter;
+
+// ============================================================================
+
 typedef struct TDA8425_ChipFloat
 {
     TDA8425_Register reg_vl_;
@@ -389,6 +507,20 @@ typedef struct TDA8425_ChipFloat
     TDA8425_Tfilter_Mode tfilter_mode_;
     TDA8425_BiQuadModel tfilter_model_;
     TDA8425_BiQuadState tfilter_state_[TDA8425_Stereo_Count];
+
+    unsigned blocks_dirty_;
+    TDA8425_BiLinBlock dcremoval_block_;
+    TDA8425_BiQuadBlock pseudo_block_;
+    TDA8425_BiLinBlock bass_block_;
+    TDA8425_BiLinBlock treble_block_;
+    TDA8425_BiQuadBlock tfilter_block_;
+
+    TDA8425_Recorder* recorder_;
+    TDA8425_Meter* meter_;
+
+#if TDA8425_USE_COUNTERS
+    TDA8425_Counters counters_;
+#endif
 } TDA8425_Chip;
 
 typedef struct TDA8425_Chip_Process_Data
@@ -397,6 +529,16 @@ typedef struct TDA8425_Chip_Process_Data
     TDA8425_Float outputs[TDA8425_Stereo_Count];
 } TDA8425_Chip_Process_Data;
 
+//! Intermediate signals, tapped after each processing stage
+typedef enum TDA8425_Tap {
+    TDA8425_Tap_Selector  = 0,
+    TDA8425_Tap_DCRemoval = 1,
+    TDA8425_Tap_Mode      = 2,  //!< After stereo mode
+    TDA8425_Tap_Bass      = 3,  //!< After volume and bass
+    TDA8425_Tap_Treble    = 4,
+    TDA8425_Tap_Count     = 5
+} TDA8425_Tap;
+
 // ----------------------------------------------------------------------------
 
 void TDA8425_Chip_Ctor(TDA8425_Chip* self);
@@ -422,6 +564,21 @@ void TDA8425_Chip_Process(
     TDA8425_Chip_Process_Data* data
 );
 
+void TDA8425_Chip_ProcessBlock(
+    TDA8425_Chip* self,
+    TDA8425_Chip_Process_Data data[],
+    TDA8425_Index count
+);
+
+//! As TDA8425_Chip_ProcessBlock(), also storing intermediate signals.
+//! Each non-NULL tap receives count interleaved stereo frames.
+void TDA8425_Chip_ProcessBlockTaps(
+    TDA8425_Chip* self,
+    TDA8425_Chip_Process_Data data[],
+    TDA8425_Index count,
+    TDA8425_Float* const taps[TDA8425_Tap_Count]
+);
+
 TDA8425_Register TDA8425_Chip_Read(
     TDA8425_Chip const* self,
     TDA8425_Address address
@@ -433,6 +590,279 @@ void TDA8425_Chip_Write(
     TDA8425_Register data
 );
 
+bool TDA8425_Chip_GetCounters(
+    TDA8425_Chip const* self,
+    TDA8425_Counters* counters
+);
+
+void TDA8425_Chip_ResetCounters(TDA8425_Chip* self);
+
+void TDA8425_Chip_SetRecorder(
+    TDA8425_Chip* self,
+    TDA8425_Recorder* recorder
+);
+
+void TDA8425_Chip_SetMeter(
+    TDA8425_Chip* self,
+    TDA8425_Meter* meter
+);
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Meter_Reset(TDA8425_Meter* self);
+
+TDA8425_Float TDA8425_Meter_GetRms(
+    TDA8425_Meter const* self,
+    TDA8425_Stereo channel
+);
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Recorder_Setup(
+    TDA8425_Recorder* self,
+    TDA8425_WriteRecord* records,
+    TDA8425_Index capacity
+);
+
+void TDA8425_Recorder_Reset(
+    TDA8425_Recorder* self,
+    uint64_t frame
+);
+
+TDA8425_Index TDA8425_Recorder_Read(
+    TDA8425_Recorder const* self,
+    TDA8425_WriteRecord records[],
+    TDA8425_Index capacity
+);
+
+uint64_t TDA8425_Recorder_GetDropped(TDA8425_Recorder const* self);
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_GetResponse(
+    TDA8425_Chip const* self,
+    TDA8425_Stereo channel,
+    TDA8425_Float const frequencies[],
+    TDA8425_Index count,
+    TDA8425_Float magnitudes[],
+    TDA8425_Float phases[]
+);
+
+// ============================================================================
+
+#define TDA8425_SNAPSHOT_VERSION 1  //!< Snapshot format version
+
+//! Snapshot tag: magic, format version, and floating point data size
+#define TDA8425_SNAPSHOT_TAG (                  \
+    ((uint32_t)'T' << 24) |                     \
+    ((uint32_t)TDA8425_SNAPSHOT_VERSION << 8) | \
+    (uint32_t)sizeof(TDA8425_Float)             \
+)
+
+//! Filter state vector layout
+enum TDA8425_StateLayout {
+    TDA8425_State_DCRemoval_L =  0,  // x0, y0
+    TDA8425_State_DCRemoval_R =  2,  // x0, y0
+    TDA8425_State_Pseudo      =  4,  // x0, x1, y0, y1
+    TDA8425_State_Bass_L      =  8,  // x0, y0
+    TDA8425_State_Bass_R      = 10,  // x0, y0
+    TDA8425_State_Treble_L    = 12,  // x0, y0
+    TDA8425_State_Treble_R    = 14,  // x0, y0
+    TDA8425_State_Tfilter_L   = 16,  // x0, x1, y0, y1
+    TDA8425_State_Tfilter_R   = 20,  // x0, x1, y0, y1
+
+    TDA8425_State_Count       = 24
+};
+
+//! Compact chip snapshot: registers and filter states only.
+//! Without padding bytes, so that equal snapshots compare and hash equal;
+//! native endianness, not encoded by the tag.
+typedef struct TDA8425_ChipSnapshot
+{
+    uint32_t tag;
+    TDA8425_Register regs[TDA8425_RegOrder_Count];
+    uint8_t reserved_[16 - sizeof(uint32_t) - TDA8425_RegOrder_Count];  //!< Zeroed
+    TDA8425_Float state[TDA8425_State_Count];
+} TDA8425_ChipSnapshot;
+
+//! Snapshot held by a rollback ring, with its frame index
+typedef struct TDA8425_SnapshotEntry
+{
+    TDA8425_Index frame;
+    TDA8425_ChipSnapshot snapshot;
+} TDA8425_SnapshotEntry;
+
+//! Fixed-capacity rollback ring of periodic snapshots
+typedef struct TDA8425_SnapshotRing
+{
+    TDA8425_SnapshotEntry* entries_;
+    TDA8425_Index capacity_;
+    TDA8425_Index interval_;
+    TDA8425_Index head_;
+    TDA8425_Index count_;
+    TDA8425_Index next_frame_;
+} TDA8425_SnapshotRing;
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_GetState(
+    TDA8425_Chip const* self,
+    TDA8425_Float state[TDA8425_State_Count]
+);
+
+void TDA8425_Chip_SetState(
+    TDA8425_Chip* self,
+    TDA8425_Float const state[TDA8425_State_Count]
+);
+
+void TDA8425_Chip_SaveSnapshot(
+    TDA8425_Chip const* self,
+    TDA8425_ChipSnapshot* snapshot
+);
+
+bool TDA8425_Chip_LoadSnapshot(
+    TDA8425_Chip* self,
+    TDA8425_ChipSnapshot const* snapshot
+);
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_SnapshotRing_Setup(
+    TDA8425_SnapshotRing* self,
+    TDA8425_SnapshotEntry* entries,
+    TDA8425_Index capacity,
+    TDA8425_Index interval
+);
+
+void TDA8425_SnapshotRing_Reset(
+    TDA8425_SnapshotRing* self,
+    TDA8425_Index frame
+);
+
+bool TDA8425_SnapshotRing_Capture(
+    TDA8425_SnapshotRing* self,
+    TDA8425_Chip const* chip,
+    TDA8425_Index frame
+);
+
+bool TDA8425_SnapshotRing_Restore(
+    TDA8425_SnapshotRing* self,
+    TDA8425_Chip* chip,
+    TDA8425_Index frame,
+    TDA8425_Index* restored_frame
+);
+
+// ============================================================================
+
+//! Task callback for parallel execution, see TDA8425_ForEach
+typedef void (*TDA8425_Task)(void* arg, TDA8425_Index index);
+
+//! Executes task(arg, index) for each index in [0, count), possibly in parallel
+typedef void (*TDA8425_ForEach)(
+    void* context,
+    TDA8425_Task task,
+    void* arg,
+    TDA8425_Index count
+);
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Chip_GetTransition(
+    TDA8425_Chip const* self,
+    TDA8425_Index frames,
+    TDA8425_Float matrix[TDA8425_State_Count][TDA8425_State_Count]
+);
+
+void TDA8425_State_Propagate(
+    TDA8425_Float const matrix[TDA8425_State_Count][TDA8425_State_Count],
+    TDA8425_Float const initial[TDA8425_State_Count],
+    TDA8425_Float const forced[TDA8425_State_Count],
+    TDA8425_Float result[TDA8425_State_Count]
+);
+
+bool TDA8425_Chip_ProcessChunked(
+    TDA8425_Chip* self,
+    TDA8425_Chip_Process_Data data[],
+    TDA8425_Index count,
+    TDA8425_Index chunk_count,
+    TDA8425_ForEach for_each,
+    void* context
+);
+
+// ============================================================================
+
+//! Resampler quality presets
+typedef enum TDA8425_Resampler_Quality {
+    TDA8425_Resampler_Quality_Low    = 0,  //!< 16 taps
+    TDA8425_Resampler_Quality_Medium = 1,  //!< 32 taps
+    TDA8425_Resampler_Quality_High   = 2,  //!< 64 taps
+
+    TDA8425_Resampler_Quality_Count  = 3
+} TDA8425_Resampler_Quality;
+
+//! Resampler specifications
+enum TDA8425_ResamplerSpecifications {
+    TDA8425_Resampler_Phases   = 256,  //!< Polyphase table rows, interpolated
+    TDA8425_Resampler_Max_Taps = 64
+};
+
+//! Polyphase FIR stereo resampler
+typedef struct TDA8425_Resampler
+{
+    TDA8425_Float input_rate_;
+    TDA8425_Float output_rate_;
+    TDA8425_Resampler_Quality quality_;
+    unsigned taps_;
+    TDA8425_Float* table_;  // [TDA8425_Resampler_Phases + 1][taps_]
+    uint64_t step_;   // 32.32 fixed point
+    uint64_t phase_;  // 32.32 fixed point
+    unsigned position_;
+    TDA8425_Float history_[TDA8425_Stereo_Count][TDA8425_Resampler_Max_Taps * 2];
+} TDA8425_Resampler;
+
+// ----------------------------------------------------------------------------
+
+void TDA8425_Resampler_Ctor(TDA8425_Resampler* self);
+
+void TDA8425_Resampler_Dtor(TDA8425_Resampler* self);
+
+bool TDA8425_Resampler_Setup(
+    TDA8425_Resampler* self,
+    TDA8425_Float input_rate,
+    TDA8425_Float output_rate,
+    TDA8425_Resampler_Quality quality
+);
+
+void TDA8425_Resampler_Reset(TDA8425_Resampler* self);
+
+TDA8425_Float TDA8425_Resampler_GetChipRate(
+    TDA8425_Resampler const* self
+);
+
+TDA8425_Index TDA8425_Resampler_GetMaxOutputs(
+    TDA8425_Resampler const* self,
+    TDA8425_Index input_count
+);
+
+TDA8425_Index TDA8425_Resampler_Process(
+    TDA8425_Resampler* self,
+    TDA8425_Float const inputs[][TDA8425_Stereo_Count],
+    TDA8425_Index input_count,
+    TDA8425_Float outputs[][TDA8425_Stereo_Count],
+    TDA8425_Index output_capacity
+);
+
+// ----------------------------------------------------------------------------
+
+TDA8425_Index TDA8425_Chip_ProcessResampled(
+    TDA8425_Chip* self,
+    TDA8425_Resampler* resampler,
+    TDA8425_Float const inputs[][TDA8425_Source_Count][TDA8425_Stereo_Count],
+    TDA8425_Index input_count,
+    TDA8425_Float outputs[][TDA8425_Stereo_Count],
+    TDA8425_Index output_capacity
+);
+
 // ============================================================================
 
 #ifdef __cplusplus